@@ -21,6 +21,7 @@ install(TARGETS
 
 # Package sample application executable
 install(FILES $<TARGET_FILE:app-console> DESTINATION bin)
+install(FILES $<TARGET_FILE:app-log-decoder> DESTINATION bin)
 
 # Redistribute dependency headers
 install(DIRECTORY "${CPM_PACKAGE_cxxopts_SOURCE_DIR}/include/" DESTINATION include FILES_MATCHING PATTERN "*.h*")
@@ -45,6 +46,8 @@ endif()
 
 # Generate & install project config file
 string(JOIN "\n" file_content
+	"include(CMakeFindDependencyMacro)"
+	"find_dependency(Threads)"
 	"include(\"\${CMAKE_CURRENT_LIST_DIR}/${export_name}-targets.cmake\")"
 	"")  # Empty line
 
@@ -1,7 +1,9 @@
 #include "cli.hxx"
 
+#include <cstdint>
 #include <filesystem>
 #include <iostream>
+#include <string>
 
 #include <project.hxx>
 
@@ -25,8 +27,28 @@ Cli::Cli(char const* argv_0)
 #if ENABLE_LOGGING
 		("l,log-level", "Set log level. LEVEL=error|warning|info|debug|trace",
 			cxxopts::value<std::string>()->default_value("none"), "LEVEL")
+		("b,binary-log", "Write trace & debug messages to a binary log FILE. Decode with app-log-decoder",
+			cxxopts::value<std::string>(), "FILE")
 #endif
 		;  // terminate add_options()
+
+	LoadOptions const defaults;
+
+	_options.add_options("Load generator")
+		("load", "Stress TypeExchange instead of running the demo, then report throughput & latency")
+		("producers", "Publishing threads",
+			cxxopts::value<std::size_t>()->default_value(std::to_string(defaults.producers)), "N")
+		("types", "Message types, at most " + std::to_string(LoadOptions::max_types),
+			cxxopts::value<std::size_t>()->default_value(std::to_string(defaults.types)), "N")
+		("subscribers", "Subscribers per message type",
+			cxxopts::value<std::size_t>()->default_value(std::to_string(defaults.subscribers)), "N")
+		("payload", "Bytes per message",
+			cxxopts::value<std::size_t>()->default_value(std::to_string(defaults.payload)), "BYTES")
+		("messages", "Total messages to publish",
+			cxxopts::value<std::uint64_t>()->default_value(std::to_string(defaults.messages)), "N")
+		("tick", "Microseconds between process_messages() calls; 0 to spin",
+			cxxopts::value<std::int64_t>()->default_value(std::to_string(defaults.tick.count())), "US")
+		;  // terminate add_options()
 	// clang-format on
 }
 
@@ -78,3 +100,44 @@ auto Cli::log_level() const -> std::optional<std::string>
 		return std::nullopt;
 	}
 }
+
+auto Cli::load() const -> std::optional<LoadOptions>
+{
+	if (!_result.count("load")) {
+		return std::nullopt;
+	}
+
+	LoadOptions options;
+	options.producers = _result["producers"].as<std::size_t>();
+	options.types = _result["types"].as<std::size_t>();
+	options.subscribers = _result["subscribers"].as<std::size_t>();
+	options.payload = _result["payload"].as<std::size_t>();
+	options.messages = _result["messages"].as<std::uint64_t>();
+	options.tick = std::chrono::microseconds {_result["tick"].as<std::int64_t>()};
+
+	auto const invalid = [this](std::string const& error) {
+		std::cerr << "Error parsing options:\n\t" << error << "\n\n";
+		std::cerr << _options.help() << std::endl;
+		std::exit(1);
+	};
+
+	if (options.producers == 0) {
+		invalid("--producers must be at least 1");
+	}
+
+	if (options.types == 0 || options.types > LoadOptions::max_types) {
+		invalid("--types must be between 1 and " + std::to_string(LoadOptions::max_types));
+	}
+
+	return options;
+}
+
+auto Cli::binary_log() const -> std::optional<std::string>
+{
+	if (_result.count("binary-log")) {
+		return _result["binary-log"].as<std::string>();
+	}
+	else {
+		return std::nullopt;
+	}
+}
@@ -6,6 +6,8 @@
 
 #include <cxxopts.hpp>
 
+#include <load.hxx>
+
 class Cli
 {
 public:
@@ -19,6 +21,10 @@ public:
 	Cli(int argc, char const* argv[]);
 
 	auto log_level() const -> std::optional<std::string>;
+	auto binary_log() const -> std::optional<std::string>;
+
+	/// Load generator settings if the user provides @c --load. Exits like the constructor if any are out of range.
+	auto load() const -> std::optional<LoadOptions>;
 
 private:
 	explicit Cli(char const* argv_0);
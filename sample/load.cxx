@@ -0,0 +1,233 @@
+#include "load.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <type-exchange.hxx>
+
+using namespace project;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::uint64_t constexpr producer_batch {64};  // Messages published per lock
+
+/// One distinct message type per index
+template <std::size_t I>
+struct LoadMessage
+{
+	std::vector<unsigned char> payload;
+};
+
+using Subscribe = void (*)(TypeExchange&, std::uint64_t& delivered);
+using Publish = void (*)(TypeExchange&, std::size_t payload);
+
+template <std::size_t I>
+void subscribe(TypeExchange& exchange, std::uint64_t& delivered)
+{
+	exchange.subscribe<LoadMessage<I>>([&delivered](LoadMessage<I> const&) { ++delivered; });
+}
+
+template <std::size_t I>
+void publish(TypeExchange& exchange, std::size_t payload)
+{
+	exchange.publish(LoadMessage<I> {std::vector<unsigned char>(payload)});
+}
+
+// Map runtime type indices to compile-time types
+template <std::size_t... I>
+auto constexpr make_subscribers(std::index_sequence<I...>) -> std::array<Subscribe, sizeof...(I)>
+{
+	return {&subscribe<I>...};
+}
+
+template <std::size_t... I>
+auto constexpr make_publishers(std::index_sequence<I...>) -> std::array<Publish, sizeof...(I)>
+{
+	return {&publish<I>...};
+}
+
+auto constexpr subscribers {make_subscribers(std::make_index_sequence<LoadOptions::max_types> {})};
+auto constexpr publishers {make_publishers(std::make_index_sequence<LoadOptions::max_types> {})};
+
+auto peak_rss_bytes() -> std::size_t
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters {};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	rusage usage {};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+#ifdef __APPLE__
+	return static_cast<std::size_t>(usage.ru_maxrss);  // bytes
+#else
+	return static_cast<std::size_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#endif
+#endif
+}
+
+auto percentile(std::vector<std::chrono::nanoseconds> const& sorted, double fraction) -> std::chrono::nanoseconds
+{
+	if (sorted.empty()) {
+		return {};
+	}
+
+	auto const index {static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1))};
+	return sorted[index];
+}
+
+}  // namespace
+
+auto run_load(LoadOptions const& options) -> LoadReport
+{
+	if (options.producers == 0) {
+		throw std::invalid_argument {"Load generator needs at least 1 producer"};
+	}
+
+	if (options.types == 0 || options.types > LoadOptions::max_types) {
+		throw std::invalid_argument {"Load generator supports 1 to " + std::to_string(LoadOptions::max_types)
+		                             + " message types"};
+	}
+
+	auto const types {options.types};
+	auto const producers {options.producers};
+
+	TypeExchange exchange;
+	std::mutex mutex;
+
+	std::uint64_t delivered {0};  // Only modified by subscribers, under `mutex`
+
+	for (std::size_t type {0}; type < types; ++type) {
+		for (std::size_t i {0}; i < options.subscribers; ++i) {
+			subscribers[type](exchange, delivered);
+		}
+	}
+
+	std::atomic<std::size_t> producers_done {0};
+	std::atomic<bool> consumer_waiting {false};
+	std::vector<std::thread> threads;
+
+	auto const start {Clock::now()};
+
+	for (std::size_t p {0}; p < producers; ++p) {
+		// Spread the remainder over the first producers
+		auto const count {options.messages / producers + (p < options.messages % producers ? 1 : 0)};
+
+		threads.emplace_back([&, p, count] {
+			for (std::uint64_t i {0}; i < count;) {
+				// std::mutex is not fair: without this, producers could keep the consumer out for many ticks
+				while (consumer_waiting.load(std::memory_order_relaxed)) {
+					std::this_thread::yield();
+				}
+
+				std::lock_guard const lock {mutex};
+
+				for (auto const end {std::min(count, i + producer_batch)}; i < end; ++i) {
+					publishers[(p + i) % types](exchange, options.payload);
+				}
+			}
+			producers_done.fetch_add(1, std::memory_order_release);
+		});
+	}
+
+	std::vector<std::chrono::nanoseconds> ticks;
+
+	for (bool done {false}; !done;) {
+		auto const tick_start {Clock::now()};
+
+		// Read before processing, so the final tick sees every published message
+		done = producers_done.load(std::memory_order_acquire) == producers;
+
+		consumer_waiting.store(true, std::memory_order_relaxed);
+
+		{
+			std::lock_guard const lock {mutex};
+			consumer_waiting.store(false, std::memory_order_relaxed);
+
+			// Exclude time spent waiting for producers to release the lock
+			auto const process_start {Clock::now()};
+			exchange.process_messages();
+			ticks.push_back(Clock::now() - process_start);
+		}
+
+		if (!done && options.tick.count() > 0) {
+			std::this_thread::sleep_until(tick_start + options.tick);
+		}
+	}
+
+	auto const elapsed {Clock::now() - start};
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	std::sort(ticks.begin(), ticks.end());
+
+	LoadReport report;
+	report.published = options.messages;
+	report.delivered = delivered;
+	report.elapsed = elapsed;
+	report.messages_per_second = static_cast<double>(options.messages)
+	                             / std::chrono::duration<double>(elapsed).count();
+	report.ticks = ticks.size();
+	report.requested_ticks = options.tick.count() > 0 ? static_cast<std::size_t>(elapsed / options.tick) + 1 : 0;
+	report.tick_p50 = percentile(ticks, 0.50);
+	report.tick_p90 = percentile(ticks, 0.90);
+	report.tick_p99 = percentile(ticks, 0.99);
+	report.tick_max = ticks.empty() ? std::chrono::nanoseconds {} : ticks.back();
+	report.peak_rss_bytes = peak_rss_bytes();
+
+	return report;
+}
+
+auto operator<<(std::ostream& out, LoadReport const& report) -> std::ostream&
+{
+	auto const us = [](std::chrono::nanoseconds const ns) { return std::chrono::duration<double, std::micro>(ns).count(); };
+
+	out << "Published:    " << report.published << " messages\n";
+	out << "Delivered:    " << report.delivered << " callbacks\n";
+	out << "Elapsed:      " << std::chrono::duration<double>(report.elapsed).count() << " s\n";
+	out << "Throughput:   " << report.messages_per_second << " messages/s\n";
+	out << "Ticks:        " << report.ticks;
+
+	if (report.requested_ticks) {
+		out << " of " << report.requested_ticks << " requested";
+	}
+
+	out << '\n';
+	out << "Tick latency: p50 " << us(report.tick_p50) << " us, p90 " << us(report.tick_p90) << " us, p99 "
+	    << us(report.tick_p99) << " us, max " << us(report.tick_max) << " us\n";
+	out << "Peak RSS:     ";
+
+	if (report.peak_rss_bytes) {
+		out << report.peak_rss_bytes / (1024 * 1024) << " MiB\n";
+	}
+	else {
+		out << "unavailable\n";
+	}
+
+	return out;
+}
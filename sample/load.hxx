@@ -0,0 +1,54 @@
+#ifndef LOAD_HXX
+#define LOAD_HXX
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+/// Load generator settings. See Cli for the corresponding options.
+struct LoadOptions
+{
+	std::size_t producers {4};  // Publishing threads, at least 1
+	std::size_t types {4};  // Distinct message types, from 1 to LoadOptions::max_types
+	std::size_t subscribers {1};  // Subscribers per message type
+	std::size_t payload {64};  // Bytes per message
+	std::uint64_t messages {1'000'000};  // Total messages across all producers
+	std::chrono::microseconds tick {1000};  // Time between process_messages() calls; 0 to spin
+
+	static std::size_t constexpr max_types {16};
+};
+
+struct LoadReport
+{
+	std::uint64_t published {};
+	std::uint64_t delivered {};  // published * subscribers when complete
+	std::chrono::nanoseconds elapsed {};
+	double messages_per_second {};
+
+	// Duration of each process_messages() call, excluding time waiting on producers
+	std::size_t ticks {};
+	std::size_t requested_ticks {};  // Ticks which fit in `elapsed` at LoadOptions::tick; 0 when spinning
+	std::chrono::nanoseconds tick_p50 {};
+	std::chrono::nanoseconds tick_p90 {};
+	std::chrono::nanoseconds tick_p99 {};
+	std::chrono::nanoseconds tick_max {};
+
+	std::size_t peak_rss_bytes {};  // 0 if unavailable
+};
+
+/** @brief Stress a TypeExchange with concurrent producers.
+
+    Producer threads publish round-robin across message types while the
+    calling thread calls process_messages() every @c options.tick. TypeExchange
+    is not thread-safe, so producers and the consumer share one mutex.
+    Producers publish several messages per lock and give way whenever the
+    consumer is waiting for it, so that ticks keep to their schedule.
+
+    @throws std::invalid_argument if @c options.producers or @c options.types is out of range.
+ */
+auto run_load(LoadOptions const& options) -> LoadReport;
+
+auto operator<<(std::ostream& out, LoadReport const& report) -> std::ostream&;
+
+#endif  // LOAD_HXX
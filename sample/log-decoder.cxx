@@ -0,0 +1,53 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <cstdio>  // for std::fopen
+#undef _CRT_SECURE_NO_WARNINGS
+
+#include <iostream>
+
+#include <project.hxx>
+
+using namespace project;
+
+/** Convert a binary log written by log::binary to text.
+
+    Usage: app-log-decoder <binary-log> [output]
+
+    Writes to stdout if no output file is given.
+ */
+int main(int const argc, char const* argv[])
+{
+	if (argc < 2 || argc > 3) {
+		std::cerr << "Usage: " << argv[0] << " <binary-log> [output]" << std::endl;
+		return 1;
+	}
+
+	std::FILE* in {std::fopen(argv[1], "rb")};
+
+	if (!in) {
+		std::cerr << "Cannot open input: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::FILE* out {argc == 3 ? std::fopen(argv[2], "w") : stdout};
+
+	if (!out) {
+		std::cerr << "Cannot open output: " << argv[2] << std::endl;
+		std::fclose(in);
+		return 1;
+	}
+
+	bool const ok {log::binary::decode(in, out)};
+
+	std::fclose(in);
+
+	if (out != stdout) {
+		std::fclose(out);
+	}
+
+	if (!ok) {
+		std::cerr << "Input is not a binary log or is truncated: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -7,6 +7,7 @@
 #include <string>
 
 #include <cli.hxx>
+#include <load.hxx>
 #include <project.hxx>
 
 #include <type-exchange.hxx>
@@ -65,8 +66,17 @@ int main(int const argc, char const* argv[])
 #if ENABLE_LOGGING
 	set_log_level(cli.log_level());
 	log::print_enabled_levels();
+
+	if (auto const path {cli.binary_log()}; path && !log::binary::open(path->c_str())) {
+		log::error("Cannot open binary log: {}", path.value());
+	}
 #endif
 
+	if (auto const load_options {cli.load()}) {
+		std::cout << run_load(load_options.value()) << std::flush;
+		return 0;
+	}
+
 	std::cout << "Welcome!\n" << std::endl;
 
 	TypeExchange exchange;
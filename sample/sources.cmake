@@ -14,6 +14,8 @@ target_sources(${target}  # parent scope defines ${target}
 
 		${source_dir}/cli.cxx
 		${source_dir}/cli.hxx
+		${source_dir}/load.cxx
+		${source_dir}/load.hxx
 )
 target_include_directories(${target}
 	PRIVATE
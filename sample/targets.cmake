@@ -28,6 +28,21 @@ target_link_libraries(${target}
 	PRIVATE
 		project
 		cxxopts::cxxopts
+		$<$<PLATFORM_ID:Windows>:psapi>  # for peak memory in load.cxx
+)
+
+#################
+#  Log decoder  #
+#################
+
+set(target "app-log-decoder")
+
+add_executable(${target}
+	"${source_dir}/log-decoder.cxx"
+)
+target_link_libraries(${target}
+	PRIVATE
+		project
 )
 
 unset(binary_dir)
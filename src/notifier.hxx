@@ -0,0 +1,155 @@
+#ifndef NOTIFIER_HXX
+#define NOTIFIER_HXX
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#ifdef __linux__
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace project::detail {
+
+/** @brief Wakes one waiting thread from any other thread.
+
+    Notifications are sticky: a notify() with no thread waiting makes the
+    next wait return at once. Several notifications before a wait count as
+    one.
+
+    On Linux this is an eventfd, which can also be polled alongside other
+    descriptors. Elsewhere, or if the eventfd cannot be created, it falls
+    back to a condition variable and offers no descriptor.
+ */
+class Notifier
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	Notifier();
+	~Notifier();
+
+	Notifier(Notifier const&) = delete;
+	Notifier& operator=(Notifier const&) = delete;
+
+	void notify();
+
+	/// Block until notified or @p deadline passes, then consume any notification.
+	void wait_until(Clock::time_point deadline);
+
+	/// Descriptor which polls readable while a notification is pending; -1 if unavailable.
+	auto handle() const -> int;
+
+private:
+#ifdef __linux__
+	void wait_descriptor(Clock::time_point deadline);
+#endif
+
+	int _fd {-1};
+
+	// Fallback when there is no descriptor
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _notified {false};
+};
+
+inline Notifier::Notifier()
+{
+#ifdef __linux__
+	_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);  // -1 on failure, e.g. out of descriptors
+#endif
+}
+
+inline Notifier::~Notifier()
+{
+#ifdef __linux__
+	if (_fd >= 0) {
+		close(_fd);
+	}
+#endif
+}
+
+inline void Notifier::notify()
+{
+#ifdef __linux__
+	if (_fd >= 0) {
+		std::uint64_t const one {1};
+
+		while (write(_fd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+		return;
+	}
+#endif
+
+	{
+		std::lock_guard const lock {_mutex};
+		_notified = true;
+	}
+	_condition.notify_one();
+}
+
+inline void Notifier::wait_until(Clock::time_point const deadline)
+{
+#ifdef __linux__
+	if (_fd >= 0) {
+		wait_descriptor(deadline);
+		return;
+	}
+#endif
+
+	std::unique_lock lock {_mutex};
+
+	auto const notified = [this] { return _notified; };
+
+	if (deadline == Clock::time_point::max()) {
+		_condition.wait(lock, notified);
+	}
+	else {
+		_condition.wait_until(lock, deadline, notified);
+	}
+
+	_notified = false;
+}
+
+inline auto Notifier::handle() const -> int
+{
+	return _fd;
+}
+
+#ifdef __linux__
+
+inline void Notifier::wait_descriptor(Clock::time_point const deadline)
+{
+	pollfd descriptor {_fd, POLLIN, 0};
+
+	for (;;) {
+		int timeout_ms {-1};
+
+		if (deadline != Clock::time_point::max()) {
+			auto const remaining {std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now())};
+			auto constexpr max_ms {std::chrono::milliseconds {std::numeric_limits<int>::max()}};
+
+			timeout_ms = static_cast<int>(std::clamp(remaining, std::chrono::milliseconds {0}, max_ms).count());
+		}
+
+		if (poll(&descriptor, 1, timeout_ms) >= 0 || errno != EINTR) {
+			break;
+		}
+	}
+
+	// Reading resets the counter; fails harmlessly with EAGAIN if nothing was pending
+	std::uint64_t count;
+	(void) read(_fd, &count, sizeof(count));
+}
+
+#endif
+
+}  // namespace project::detail
+
+#endif  // NOTIFIER_HXX
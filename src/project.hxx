@@ -6,6 +6,7 @@
 #include <project_dll-export.h>
 
 // Include all public headers
+#include <log-mapped-file.hxx>
 #include <log.hxx>
 #include <version.h>
 
@@ -0,0 +1,158 @@
+#ifndef SNAPSHOT_HXX
+#define SNAPSHOT_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace project::detail {
+
+/** @brief Immutable value which writers replace wholesale (read-copy-update).
+
+    Readers take a lock-free snapshot with read() and may use it for as long
+    as they hold the returned Reader, even while writers publish new versions.
+    Writers serialize on a mutex, copy the current value, modify the copy, and
+    swap it in.
+
+    Replaced versions are reclaimed once no reader is active, by the next
+    writer or by the last reader to finish. A reader only ever counts itself
+    in and out, so readers never wait on writers or on each other.
+ */
+template <typename T>
+class SnapshotCell
+{
+public:
+	class Reader
+	{
+	public:
+		explicit Reader(SnapshotCell const& cell);
+		~Reader();
+
+		Reader(Reader const&) = delete;
+		Reader& operator=(Reader const&) = delete;
+
+		auto operator*() const -> T const&;
+		auto operator->() const -> T const*;
+
+	private:
+		SnapshotCell const& _cell;
+		T const* _value;
+	};
+
+	SnapshotCell();
+	~SnapshotCell();
+
+	SnapshotCell(SnapshotCell const&) = delete;
+	SnapshotCell& operator=(SnapshotCell const&) = delete;
+
+	auto read() const -> Reader;
+
+	/// Publish a copy of the current value as changed by @p modify(T&). Returns what @p modify returns.
+	template <typename Modify>
+	auto update(Modify&& modify);
+
+private:
+	// Requires _writer_mutex
+	void reclaim() const;
+
+	std::atomic<T const*> _current;
+	mutable std::atomic<std::size_t> _readers {0};
+
+	mutable std::mutex _writer_mutex;
+	mutable std::vector<std::unique_ptr<T const>> _retired;
+	mutable std::atomic<bool> _has_retired {false};
+};
+
+template <typename T>
+SnapshotCell<T>::Reader::Reader(SnapshotCell const& cell)
+    : _cell {cell}
+{
+	// Count in before loading, so that a writer which sees no readers cannot free what is loaded here
+	_cell._readers.fetch_add(1, std::memory_order_seq_cst);
+	_value = _cell._current.load(std::memory_order_seq_cst);
+}
+
+template <typename T>
+SnapshotCell<T>::Reader::~Reader()
+{
+	auto const last {_cell._readers.fetch_sub(1, std::memory_order_seq_cst) == 1};
+
+	if (last && _cell._has_retired.load(std::memory_order_relaxed)) {
+		std::unique_lock const lock {_cell._writer_mutex, std::try_to_lock};
+
+		if (lock) {
+			_cell.reclaim();
+		}
+	}
+}
+
+template <typename T>
+auto SnapshotCell<T>::Reader::operator*() const -> T const&
+{
+	return *_value;
+}
+
+template <typename T>
+auto SnapshotCell<T>::Reader::operator->() const -> T const*
+{
+	return _value;
+}
+
+template <typename T>
+SnapshotCell<T>::SnapshotCell()
+    : _current {new T {}}
+{}
+
+template <typename T>
+SnapshotCell<T>::~SnapshotCell()
+{
+	delete _current.load();
+}
+
+template <typename T>
+auto SnapshotCell<T>::read() const -> Reader
+{
+	return Reader {*this};
+}
+
+template <typename T>
+template <typename Modify>
+auto SnapshotCell<T>::update(Modify&& modify)
+{
+	std::lock_guard const lock {_writer_mutex};
+
+	auto next {std::make_unique<T>(*_current.load(std::memory_order_relaxed))};
+
+	auto finish = [&] {
+		_retired.emplace_back(_current.exchange(next.release(), std::memory_order_seq_cst));
+		_has_retired.store(true, std::memory_order_relaxed);
+		reclaim();
+	};
+
+	if constexpr (std::is_void_v<decltype(modify(*next))>) {
+		modify(*next);
+		finish();
+	}
+	else {
+		auto result {modify(*next)};
+		finish();
+		return result;
+	}
+}
+
+template <typename T>
+void SnapshotCell<T>::reclaim() const
+{
+	if (_readers.load(std::memory_order_seq_cst) == 0) {
+		_retired.clear();
+		_has_retired.store(false, std::memory_order_relaxed);
+	}
+}
+
+}  // namespace project::detail
+
+#endif  // SNAPSHOT_HXX
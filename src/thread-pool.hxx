@@ -0,0 +1,157 @@
+#ifndef THREAD_POOL_HXX
+#define THREAD_POOL_HXX
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace project::detail {
+
+/// Fixed set of worker threads running queued tasks in submission order.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(std::size_t threads);
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	auto size() const -> std::size_t;
+
+	/** @brief Run @p task(i) for each i in [0, @p count) and wait for all of them.
+
+	    The calling thread runs task 0 itself while workers run the rest. If
+	    any task throws, the first exception is rethrown once all have ended.
+	    Without workers, runs every task on the calling thread.
+	 */
+	void run_all(std::size_t count, std::function<void(std::size_t)> const& task);
+
+private:
+	void work();
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _available;
+	std::queue<std::function<void()>> _tasks;
+	bool _stopping {false};
+};
+
+inline ThreadPool::ThreadPool(std::size_t const threads)
+{
+	_workers.reserve(threads);
+
+	for (std::size_t i {0}; i < threads; ++i) {
+		_workers.emplace_back([this] { work(); });
+	}
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard const lock {_mutex};
+		_stopping = true;
+	}
+
+	_available.notify_all();
+
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+}
+
+inline auto ThreadPool::size() const -> std::size_t
+{
+	return _workers.size();
+}
+
+inline void ThreadPool::run_all(std::size_t const count, std::function<void(std::size_t)> const& task)
+{
+	if (count == 0) {
+		return;
+	}
+
+	if (_workers.empty()) {
+		for (std::size_t index {0}; index < count; ++index) {
+			task(index);
+		}
+		return;
+	}
+
+	std::mutex mutex;
+	std::condition_variable finished;
+	std::size_t remaining {count};
+	std::exception_ptr error;
+
+	auto const run = [&](std::size_t const index) {
+		std::exception_ptr caught;
+
+		try {
+			task(index);
+		}
+		catch (...) {
+			caught = std::current_exception();
+		}
+
+		std::lock_guard const lock {mutex};
+
+		if (caught && !error) {
+			error = caught;
+		}
+
+		if (--remaining == 0) {
+			finished.notify_one();
+		}
+	};
+
+	{
+		std::lock_guard const lock {_mutex};
+
+		for (std::size_t index {1}; index < count; ++index) {
+			_tasks.emplace([&run, index] { run(index); });
+		}
+	}
+
+	_available.notify_all();
+
+	run(0);
+
+	std::unique_lock lock {mutex};
+	finished.wait(lock, [&] { return remaining == 0; });
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+inline void ThreadPool::work()
+{
+	for (;;) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock lock {_mutex};
+			_available.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+			if (_tasks.empty()) {
+				return;
+			}
+
+			task = std::move(_tasks.front());
+			_tasks.pop();
+		}
+
+		task();
+	}
+}
+
+}  // namespace project::detail
+
+#endif  // THREAD_POOL_HXX
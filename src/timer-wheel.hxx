@@ -0,0 +1,453 @@
+#ifndef TIMER_WHEEL_HXX
+#define TIMER_WHEEL_HXX
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace project {
+
+namespace detail {
+class TimerWheel;
+}  // namespace detail
+
+/** @brief Refers to a scheduled timer so that it can be cancelled.
+
+    Stays safe to use after its timer fires or is cancelled; cancelling it
+    then has no effect.
+ */
+class TimerHandle
+{
+public:
+	TimerHandle() = default;
+
+private:
+	friend class detail::TimerWheel;
+
+	TimerHandle(std::uint32_t index, std::uint32_t generation)
+	    : _index {index}
+	    , _generation {generation}
+	{}
+
+	std::uint32_t _index {std::numeric_limits<std::uint32_t>::max()};
+	std::uint32_t _generation {};
+};
+
+namespace detail {
+
+class TimerAction
+{
+public:
+	virtual ~TimerAction() = 0;
+
+	virtual void fire() = 0;
+};
+
+inline TimerAction::~TimerAction() = default;
+
+/** @brief Hierarchical timing wheel with O(1) schedule & cancel.
+
+    Four levels of 64 slots at 1 ms resolution cover about 4.6 hours; later
+    deadlines are parked in the last level and re-sorted as time advances.
+    Timers are pooled & linked by index, so pending timers cost no allocation
+    beyond their action once the pool has grown.
+
+    Deadlines are rounded up to the wheel's resolution while advance()
+    rounds down, so a timer never fires before its deadline but may fire up
+    to 1 ms after it.
+ */
+class TimerWheel
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static auto constexpr resolution {std::chrono::milliseconds {1}};
+
+	explicit TimerWheel(Clock::time_point epoch = Clock::now());
+
+	auto schedule(Clock::time_point deadline, std::unique_ptr<TimerAction>&& action) -> TimerHandle;
+
+	/// @return False if the timer already fired or was cancelled.
+	auto cancel(TimerHandle handle) -> bool;
+
+	/// Fire every timer with a deadline at or before @p now.
+	void advance(Clock::time_point now);
+
+	/// Number of pending timers.
+	auto size() const -> std::size_t;
+
+	/** @brief Time by which advance() should next be called; Clock::time_point::max() if no timers are pending.
+
+	    Exact for timers due within 64 ms. Later timers report when they next
+	    move to a finer level, which may be earlier than their deadline.
+	 */
+	auto next_expiry() const -> Clock::time_point;
+
+	/// Bytes allocated for pooled timers, excluding their actions. The pool keeps its peak size until shrink_to_fit().
+	auto memory_usage() const -> std::size_t;
+
+	/// Free pooled timers after the last pending one. Handles to freed timers stay safe to cancel.
+	void shrink_to_fit();
+
+private:
+	using Tick = std::uint64_t;
+
+	static std::uint32_t constexpr npos {std::numeric_limits<std::uint32_t>::max()};
+
+	static unsigned constexpr slot_bits {6};
+	static std::size_t constexpr slots {std::size_t {1} << slot_bits};
+	static std::size_t constexpr levels {4};
+	static Tick constexpr slot_mask {slots - 1};
+	static Tick constexpr max_delta {Tick {1} << (slot_bits * levels)};
+
+	// One list per slot, plus one for timers which are already due
+	static std::size_t constexpr expired_list {slots * levels};
+
+	struct Node
+	{
+		std::uint32_t prev {npos};
+		std::uint32_t next {npos};
+		std::uint32_t generation {};
+		std::uint32_t list {npos};
+		Tick expires {};
+		std::unique_ptr<TimerAction> action;
+	};
+
+	auto to_tick(Clock::time_point time) const -> Tick;  // Rounds down
+	auto to_deadline_tick(Clock::time_point deadline) const -> Tick;  // Rounds up
+
+	void insert(std::uint32_t index);
+	void link(std::uint32_t index, std::size_t list);
+	void unlink(std::uint32_t index);
+	auto take(std::size_t list) -> std::uint32_t;
+	void release(std::uint32_t index);
+
+	void cascade(std::size_t level);
+	void fire(std::size_t list);
+
+	Clock::time_point _epoch;
+	Tick _now {0};  // Last tick processed
+
+	std::vector<Node> _nodes;
+	std::uint32_t _free {npos};  // Free list, linked through Node::next
+	std::size_t _size {0};
+
+	// Generation of new nodes; above that of every node shrink_to_fit() freed, so their handles never match again
+	std::uint32_t _first_generation {0};
+
+	std::array<std::uint32_t, expired_list + 1> _heads;
+	std::array<std::uint64_t, levels> _occupied {};  // Bit per non-empty slot, to skip idle ticks
+};
+
+inline TimerWheel::TimerWheel(Clock::time_point const epoch)
+    : _epoch {epoch}
+{
+	_heads.fill(npos);
+}
+
+inline auto TimerWheel::schedule(Clock::time_point const deadline, std::unique_ptr<TimerAction>&& action)
+    -> TimerHandle
+{
+	std::uint32_t index;
+
+	if (_free != npos) {
+		index = _free;
+		_free = _nodes[index].next;
+	}
+	else {
+		index = static_cast<std::uint32_t>(_nodes.size());
+		_nodes.emplace_back().generation = _first_generation;
+	}
+
+	auto& node = _nodes[index];
+
+	node.expires = to_deadline_tick(deadline);
+	node.action = std::move(action);
+
+	insert(index);
+	++_size;
+
+	return {index, node.generation};
+}
+
+inline auto TimerWheel::cancel(TimerHandle const handle) -> bool
+{
+	if (handle._index >= _nodes.size()) {
+		return false;
+	}
+
+	auto& node = _nodes[handle._index];
+
+	if (node.generation != handle._generation || !node.action) {
+		return false;
+	}
+
+	unlink(handle._index);
+	release(handle._index);
+
+	return true;
+}
+
+inline void TimerWheel::advance(Clock::time_point const now)
+{
+	auto const target {to_tick(now)};
+
+	fire(expired_list);
+
+	while (_now < target) {
+		if (_size == 0) {
+			_now = target;
+			break;
+		}
+
+		// Skip ahead while the finest levels are empty: nothing can fire before the next cascade
+		Tick skip_mask {0};
+
+		for (std::size_t level {0}; level < levels - 1 && _occupied[level] == 0; ++level) {
+			skip_mask = (Tick {1} << (slot_bits * (level + 1))) - 1;
+		}
+
+		if ((_now | skip_mask) >= target) {
+			_now = target;
+			break;
+		}
+
+		_now |= skip_mask;
+		++_now;
+
+		// Entering a new block of a level: move its timers down to finer levels
+		for (std::size_t level {1}; level < levels; ++level) {
+			if ((_now >> (slot_bits * (level - 1)) & slot_mask) != 0) {
+				break;
+			}
+			cascade(level);
+		}
+
+		fire(_now & slot_mask);
+		fire(expired_list);  // Cascaded timers which expire on this very tick
+	}
+}
+
+inline auto TimerWheel::size() const -> std::size_t
+{
+	return _size;
+}
+
+inline auto TimerWheel::next_expiry() const -> Clock::time_point
+{
+	if (_size == 0) {
+		return Clock::time_point::max();
+	}
+
+	if (_heads[expired_list] != npos) {
+		return _epoch + resolution * static_cast<Clock::rep>(_now);
+	}
+
+	auto next {std::numeric_limits<Tick>::max()};
+
+	for (std::size_t level {0}; level < levels; ++level) {
+		if (_occupied[level] == 0) {
+			continue;
+		}
+
+		auto const shift {slot_bits * level};
+		auto const start {((_now >> shift) + 1) & slot_mask};
+
+		// Bit i is the slot i + 1 slots after the current one, wrapping around
+		auto const occupied {_occupied[level]};
+		auto const rotated {start == 0 ? occupied : occupied >> start | occupied << (slots - start)};
+		auto distance {Tick {1}};
+
+		while ((rotated >> (distance - 1) & 1) == 0) {
+			++distance;
+		}
+
+		// Level 0 slots hold a single tick; other levels are reached when their block begins
+		next = std::min(next, ((_now >> shift) + distance) << shift);
+	}
+
+	return _epoch + resolution * static_cast<Clock::rep>(next);
+}
+
+inline auto TimerWheel::memory_usage() const -> std::size_t
+{
+	return _nodes.capacity() * sizeof(Node);
+}
+
+inline void TimerWheel::shrink_to_fit()
+{
+	auto keep {_nodes.size()};
+
+	// Released nodes belong to no list
+	while (keep > 0 && _nodes[keep - 1].list == npos) {
+		--keep;
+		_first_generation = std::max(_first_generation, _nodes[keep].generation);
+	}
+
+	_nodes.erase(_nodes.begin() + static_cast<std::ptrdiff_t>(keep), _nodes.end());
+	_nodes.shrink_to_fit();
+
+	// Relink the remaining free nodes, lowest index first so that later shrinks free more
+	_free = npos;
+
+	for (auto index {static_cast<std::uint32_t>(keep)}; index-- > 0;) {
+		if (_nodes[index].list == npos) {
+			_nodes[index].next = _free;
+			_free = index;
+		}
+	}
+}
+
+inline auto TimerWheel::to_tick(Clock::time_point const time) const -> Tick
+{
+	if (time <= _epoch) {
+		return 0;
+	}
+
+	return static_cast<Tick>((time - _epoch) / resolution);
+}
+
+inline auto TimerWheel::to_deadline_tick(Clock::time_point const deadline) const -> Tick
+{
+	if (deadline <= _epoch) {
+		return 0;
+	}
+
+	auto const elapsed {deadline - _epoch};
+	auto ticks {static_cast<Tick>(elapsed / resolution)};
+
+	if (resolution * static_cast<Clock::rep>(ticks) < elapsed) {
+		++ticks;
+	}
+
+	return ticks;
+}
+
+inline void TimerWheel::insert(std::uint32_t const index)
+{
+	auto const expires {_nodes[index].expires};
+
+	if (expires <= _now) {
+		link(index, expired_list);
+		return;
+	}
+
+	// Timers beyond the wheel's range wait in the last level and are re-inserted when it cascades
+	auto const slot_time {expires - _now < max_delta ? expires : _now + max_delta - 1};
+	auto const delta {slot_time - _now};
+
+	for (std::size_t level {0}; level < levels; ++level) {
+		if (delta < (Tick {1} << (slot_bits * (level + 1)))) {
+			link(index, level * slots + (slot_time >> (slot_bits * level) & slot_mask));
+			return;
+		}
+	}
+}
+
+inline void TimerWheel::link(std::uint32_t const index, std::size_t const list)
+{
+	auto& node = _nodes[index];
+
+	node.list = static_cast<std::uint32_t>(list);
+	node.prev = npos;
+	node.next = _heads[list];
+
+	if (node.next != npos) {
+		_nodes[node.next].prev = index;
+	}
+
+	_heads[list] = index;
+
+	if (list < expired_list) {
+		_occupied[list / slots] |= std::uint64_t {1} << (list % slots);
+	}
+}
+
+inline void TimerWheel::unlink(std::uint32_t const index)
+{
+	auto& node = _nodes[index];
+
+	if (node.prev != npos) {
+		_nodes[node.prev].next = node.next;
+	}
+	else {
+		_heads[node.list] = node.next;
+
+		if (node.next == npos && node.list < expired_list) {
+			_occupied[node.list / slots] &= ~(std::uint64_t {1} << (node.list % slots));
+		}
+	}
+
+	if (node.next != npos) {
+		_nodes[node.next].prev = node.prev;
+	}
+
+	node.prev = npos;
+	node.next = npos;
+	node.list = npos;
+}
+
+inline void TimerWheel::release(std::uint32_t const index)
+{
+	auto& node = _nodes[index];
+
+	node.action.reset();
+	node.list = npos;
+	++node.generation;  // Invalidate outstanding handles
+
+	node.next = _free;
+	_free = index;
+
+	--_size;
+}
+
+inline auto TimerWheel::take(std::size_t const list) -> std::uint32_t
+{
+	auto const head {_heads[list]};
+	_heads[list] = npos;
+
+	if (list < expired_list) {
+		_occupied[list / slots] &= ~(std::uint64_t {1} << (list % slots));
+	}
+
+	return head;
+}
+
+inline void TimerWheel::cascade(std::size_t const level)
+{
+	auto index {take(level * slots + (_now >> (slot_bits * level) & slot_mask))};
+
+	while (index != npos) {
+		auto const next {_nodes[index].next};
+		insert(index);
+		index = next;
+	}
+}
+
+inline void TimerWheel::fire(std::size_t const list)
+{
+	auto index {take(list)};
+
+	while (index != npos) {
+		auto const next {_nodes[index].next};
+
+		auto action {std::move(_nodes[index].action)};
+		release(index);
+
+		action->fire();
+
+		index = next;
+	}
+}
+
+}  // namespace detail
+
+}  // namespace project
+
+#endif  // TIMER_WHEEL_HXX
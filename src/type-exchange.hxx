@@ -1,38 +1,238 @@
 #ifndef TYPE_EXCHANGE_HXX
 #define TYPE_EXCHANGE_HXX
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <queue>
+#include <thread>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <notifier.hxx>
+#include <snapshot.hxx>
+#include <thread-pool.hxx>
+#include <timer-wheel.hxx>
+
 namespace project {
 
 template <typename M>
 using MessageCallback = std::function<void(M const&)>;
 
+/// Maps a message to its conflation slot; see TypeExchange::conflate().
+template <typename M>
+using ConflationKey = std::function<std::size_t(M const&)>;
+
+/// Identifies a subscription; unique within its exchange & never reused. See TypeExchange::unsubscribe().
+using SubscriptionId = std::uint64_t;
+
+/** @brief Memory held for one message type; see TypeExchange::memory_usage().
+
+    Estimates from container capacities & element sizes. Excludes memory
+    which messages & callback captures allocate themselves.
+ */
+struct TypeMemoryUsage
+{
+	std::type_index type;
+	std::size_t queue_bytes {};  // Pending & timed messages, and their containers
+	std::size_t subscriber_bytes {};
+	std::size_t handler_bytes {};  // The type's handler & its entry in the exchange
+
+	auto total() const -> std::size_t
+	{
+		return queue_bytes + subscriber_bytes + handler_bytes;
+	}
+};
+
+struct MemoryUsage
+{
+	std::vector<TypeMemoryUsage> types;
+	std::size_t exchange_bytes {};  // Shared by all types, e.g. timer & pending-type bookkeeping
+
+	auto total() const -> std::size_t
+	{
+		auto bytes {exchange_bytes};
+
+		for (auto const& type : types) {
+			bytes += type.total();
+		}
+
+		return bytes;
+	}
+};
+
 namespace detail {
 
 template <typename M>
-using SubscriberList = std::vector<MessageCallback<M>>;
+struct Subscriber
+{
+	SubscriptionId id;
+	MessageCallback<M> callback;
+};
+
+// Subscribers are shared between snapshots, so that copying a list never copies callbacks & their state
+template <typename M>
+using SubscriberList = std::vector<std::shared_ptr<Subscriber<M> const>>;
 
 template <typename M>
 using MessageQueue = std::queue<std::unique_ptr<M>>;
 
+class EventHandler;
+
+template <typename M>
+class PublishAction;
+
+/// Handlers with messages awaiting process_messages(), in order of their first publish
+using PendingHandlers = std::vector<EventHandler*>;
+
 class EventHandler
 {
 public:
+	using Clock = std::chrono::steady_clock;
+
 	virtual ~EventHandler() = 0;
 
 	virtual void process_messages() = 0;
+
+	virtual auto memory_usage() const -> TypeMemoryUsage = 0;
+
+	/// Release spare capacity. Subscriptions are unaffected.
+	virtual void shrink_to_fit() = 0;
+
+	/// Keep this handler for the exchange's lifetime, e.g. because a Channel or setting refers to it.
+	void pin();
+
+	/// Called for each timed message scheduled to, or no longer scheduled to, this handler.
+	void add_scheduled();
+	void remove_scheduled();
+
+	/// Record processing at @p now; see idle_since().
+	void mark_active(Clock::time_point now);
+	auto idle_since() const -> Clock::time_point;
+
+	/// Whether the exchange may destroy this handler without anyone noticing.
+	auto is_releasable() const -> bool;
+
+	/** @brief Register in @p pending whenever this handler goes from idle to having messages.
+
+	    @param notifier Notified when @p pending goes from empty to non-empty, once set.
+	 */
+	void track_pending(PendingHandlers* pending, std::atomic<Notifier*> const* notifier);
+
+	/// Draw subscription IDs from @p ids, shared by all handlers of an exchange, so that IDs are never reused.
+	void share_subscription_ids(std::atomic<SubscriptionId>* ids);
+
+protected:
+	/// Call on publish.
+	void mark_pending();
+
+	/// Call before dispatching, so that messages published during dispatch register again.
+	void clear_pending();
+
+	virtual auto has_subscribers() const -> bool = 0;
+
+	auto scheduled() const -> std::size_t;
+
+	auto next_subscription_id() -> SubscriptionId;
+
+private:
+	PendingHandlers* _pending {};
+	std::atomic<Notifier*> const* _notifier {};
+	bool _is_pending {false};
+
+	bool _pinned {false};
+	std::size_t _scheduled {0};
+	Clock::time_point _active {Clock::now()};
+
+	std::atomic<SubscriptionId> _own_subscription_ids {0};  // Until shared; e.g. a handler without an exchange
+	std::atomic<SubscriptionId>* _subscription_ids {&_own_subscription_ids};
 };
 
 inline EventHandler::~EventHandler() = default;
 
+inline void EventHandler::pin()
+{
+	_pinned = true;
+}
+
+inline void EventHandler::add_scheduled()
+{
+	++_scheduled;
+}
+
+inline void EventHandler::remove_scheduled()
+{
+	--_scheduled;
+}
+
+inline auto EventHandler::scheduled() const -> std::size_t
+{
+	return _scheduled;
+}
+
+inline void EventHandler::mark_active(Clock::time_point const now)
+{
+	_active = now;
+}
+
+inline auto EventHandler::idle_since() const -> Clock::time_point
+{
+	return _active;
+}
+
+inline auto EventHandler::is_releasable() const -> bool
+{
+	return !_pinned && !_is_pending && _scheduled == 0 && !has_subscribers();
+}
+
+inline void EventHandler::track_pending(PendingHandlers* pending, std::atomic<Notifier*> const* notifier)
+{
+	_pending = pending;
+	_notifier = notifier;
+}
+
+inline void EventHandler::share_subscription_ids(std::atomic<SubscriptionId>* ids)
+{
+	_subscription_ids = ids;
+}
+
+inline auto EventHandler::next_subscription_id() -> SubscriptionId
+{
+	return _subscription_ids->fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void EventHandler::mark_pending()
+{
+	if (!_pending || _is_pending) {
+		return;
+	}
+
+	_is_pending = true;
+
+	auto const was_idle {_pending->empty()};
+	_pending->push_back(this);
+
+	// Only the first message since the last processing round pays for a wakeup
+	if (was_idle) {
+		if (auto* notifier {_notifier->load(std::memory_order_acquire)}) {
+			notifier->notify();
+		}
+	}
+}
+
+inline void EventHandler::clear_pending()
+{
+	_is_pending = false;
+}
+
 template <typename M>
 class EventHandlerImpl : public EventHandler
 {
@@ -41,48 +241,357 @@ public:
 
 	void process_messages() override;
 
-	void subscribe(MessageCallback<M>&& callback);
+	auto memory_usage() const -> TypeMemoryUsage override;
+	void shrink_to_fit() override;
+
+	auto subscribe(MessageCallback<M>&& callback) -> SubscriptionId;
+	auto unsubscribe(SubscriptionId id) -> bool;
 	void publish(std::unique_ptr<M>&& message);
 
+	void conflate(ConflationKey<M>&& key);
+
+	/// Split subscribers into chunks of @p chunk_size, run on @p pool, for each batch.
+	void dispatch_in_parallel(ThreadPool& pool, std::size_t chunk_size);
+
+protected:
+	auto has_subscribers() const -> bool override;
+
 private:
-	SubscriberList<M> _subscribers;
+	void dispatch(SubscriberList<M> const& subscribers, M const& message);
+	void dispatch_parallel(SubscriberList<M> const& subscribers, MessageQueue<M>& messages);
+
+	// Changed by any thread; read without locking during dispatch
+	SnapshotCell<SubscriberList<M>> _subscribers;
+
 	MessageQueue<M> _messages;
+
+	// Conflation mode: one slot per key, overwritten by each publish. Slots are kept in first-publish order.
+	bool _conflating {false};
+	ConflationKey<M> _key;
+	std::vector<std::unique_ptr<M>> _slots;
+	std::unordered_map<std::size_t, std::size_t> _slot_index;
+
+	// Parallel mode: only used when there are more subscribers than one chunk
+	ThreadPool* _pool {};
+	std::size_t _chunk_size {};
 };
 
 template <typename M>
 void EventHandlerImpl<M>::process_messages()
 {
+	clear_pending();
+
 	MessageQueue<M> messages;
 
 	using std::swap;
 
 	swap(messages, _messages);
 
+	// Subscription changes made during dispatch apply from the next call
+	auto const subscribers {_subscribers.read()};
+
+	if (_pool && subscribers->size() > _chunk_size) {
+		dispatch_parallel(*subscribers, messages);
+		return;
+	}
+
 	while (!messages.empty()) {
-		auto const& message = *messages.front();
+		dispatch(*subscribers, *messages.front());
+		messages.pop();
+	}
 
-		for (auto const& subscriber : _subscribers) {
-			subscriber(message);
-		}
+	if (_slots.empty()) {
+		return;
+	}
+
+	std::vector<std::unique_ptr<M>> slots;
+
+	swap(slots, _slots);
+	_slot_index.clear();
+
+	for (auto const& message : slots) {
+		dispatch(*subscribers, *message);
+	}
+}
+
+template <typename M>
+auto EventHandlerImpl<M>::memory_usage() const -> TypeMemoryUsage
+{
+	TypeMemoryUsage usage {typeid(M)};
+
+	auto constexpr message_bytes {sizeof(std::unique_ptr<M>) + sizeof(M)};
+
+	usage.queue_bytes = _messages.size() * message_bytes + scheduled() * sizeof(PublishAction<M>)
+	                    + _slots.capacity() * sizeof(std::unique_ptr<M>) + _slots.size() * sizeof(M);
 
+	if (_conflating) {
+		usage.queue_bytes += _slot_index.bucket_count() * sizeof(void*)
+		                     + _slot_index.size() * (sizeof(void*) + sizeof(std::pair<std::size_t const, std::size_t>));
+	}
+
+	{
+		auto const subscribers {_subscribers.read()};
+
+		usage.subscriber_bytes = sizeof(SubscriberList<M>)
+		                         + subscribers->capacity() * sizeof(typename SubscriberList<M>::value_type)
+		                         + subscribers->size() * sizeof(Subscriber<M>);
+	}
+
+	usage.handler_bytes = sizeof(*this);
+
+	return usage;
+}
+
+template <typename M>
+void EventHandlerImpl<M>::shrink_to_fit()
+{
+	_slots.shrink_to_fit();
+
+	if (_slot_index.empty()) {
+		std::unordered_map<std::size_t, std::size_t> {}.swap(_slot_index);
+	}
+
+	auto has_spare {false};
+
+	{
+		auto const subscribers {_subscribers.read()};
+		has_spare = subscribers->capacity() > subscribers->size();
+	}
+
+	// A new version is copied at its exact size. Readers of the old version keep it until they finish.
+	if (has_spare) {
+		_subscribers.update([](SubscriberList<M>&) {});
+	}
+}
+
+template <typename M>
+auto EventHandlerImpl<M>::has_subscribers() const -> bool
+{
+	return !_subscribers.read()->empty();
+}
+
+template <typename M>
+void EventHandlerImpl<M>::dispatch(SubscriberList<M> const& subscribers, M const& message)
+{
+	for (auto const& subscriber : subscribers) {
+		subscriber->callback(message);
+	}
+}
+
+template <typename M>
+void EventHandlerImpl<M>::dispatch_parallel(SubscriberList<M> const& subscribers, MessageQueue<M>& messages)
+{
+	std::vector<std::unique_ptr<M>> batch;
+	batch.reserve(messages.size() + _slots.size());
+
+	while (!messages.empty()) {
+		batch.push_back(std::move(messages.front()));
 		messages.pop();
 	}
+
+	for (auto& message : _slots) {
+		batch.push_back(std::move(message));
+	}
+
+	_slots.clear();
+	_slot_index.clear();
+
+	// At most one chunk per worker, plus one for the calling thread
+	auto const max_chunks {std::min((subscribers.size() + _chunk_size - 1) / _chunk_size, _pool->size() + 1)};
+	auto const per_chunk {(subscribers.size() + max_chunks - 1) / max_chunks};
+
+	// Rounding per_chunk up may need fewer chunks, e.g. 10 subscribers in 8 chunks take 2 each, so only 5 chunks
+	auto const chunks {(subscribers.size() + per_chunk - 1) / per_chunk};
+
+	// Each chunk walks the whole batch in order, so every subscriber still sees messages in FIFO order
+	_pool->run_all(chunks, [&](std::size_t const chunk) {
+		auto const begin {subscribers.begin() + static_cast<std::ptrdiff_t>(chunk * per_chunk)};
+		auto const end {subscribers.begin()
+		                + static_cast<std::ptrdiff_t>(std::min(subscribers.size(), (chunk + 1) * per_chunk))};
+
+		for (auto const& message : batch) {
+			for (auto it {begin}; it != end; ++it) {
+				(*it)->callback(*message);
+			}
+		}
+	});
+}
+
+template <typename M>
+auto EventHandlerImpl<M>::subscribe(MessageCallback<M>&& callback) -> SubscriptionId
+{
+	auto subscriber {std::make_shared<Subscriber<M>>()};
+	subscriber->id = next_subscription_id();
+	subscriber->callback = std::move(callback);
+
+	auto const id {subscriber->id};
+
+	_subscribers.update([&](SubscriberList<M>& subscribers) { subscribers.push_back(std::move(subscriber)); });
+
+	return id;
 }
 
 template <typename M>
-void EventHandlerImpl<M>::subscribe(MessageCallback<M>&& callback)
+auto EventHandlerImpl<M>::unsubscribe(SubscriptionId const id) -> bool
 {
-	_subscribers.push_back(std::move(callback));
+	return _subscribers.update([id](SubscriberList<M>& subscribers) {
+		auto const it {std::find_if(subscribers.begin(), subscribers.end(), [id](auto const& subscriber) {
+			return subscriber->id == id;
+		})};
+
+		if (it == subscribers.end()) {
+			return false;
+		}
+
+		subscribers.erase(it);
+		return true;
+	});
 }
 
 template <typename M>
 void EventHandlerImpl<M>::publish(std::unique_ptr<M>&& message)
 {
-	_messages.push(std::move(message));
+	mark_pending();
+
+	if (!_conflating) {
+		_messages.push(std::move(message));
+		return;
+	}
+
+	auto const key {_key ? _key(*message) : 0};
+	auto const [it, inserted] {_slot_index.try_emplace(key, _slots.size())};
+
+	if (inserted) {
+		_slots.push_back(std::move(message));
+	}
+	else {
+		_slots[it->second] = std::move(message);
+	}
 }
 
+template <typename M>
+void EventHandlerImpl<M>::conflate(ConflationKey<M>&& key)
+{
+	_conflating = true;
+	_key = std::move(key);
+
+	// Messages queued before conflation began are conflated too
+	MessageQueue<M> messages;
+
+	using std::swap;
+
+	swap(messages, _messages);
+
+	while (!messages.empty()) {
+		publish(std::move(messages.front()));
+		messages.pop();
+	}
+}
+
+template <typename M>
+auto make_message(M&& message) -> std::unique_ptr<M>
+{
+	using PushType = std::conditional_t<std::is_move_constructible_v<M>, M&&, M const&>;
+
+	return std::make_unique<M>(static_cast<PushType>(message));
+}
+
+template <typename M>
+void EventHandlerImpl<M>::dispatch_in_parallel(ThreadPool& pool, std::size_t const chunk_size)
+{
+	_pool = &pool;
+	_chunk_size = std::max<std::size_t>(chunk_size, 1);
+}
+
+/// Publishes a message when its timer fires
+template <typename M>
+class PublishAction : public TimerAction
+{
+public:
+	PublishAction(EventHandlerImpl<M>& handler, std::unique_ptr<M>&& message)
+	    : _handler {handler}
+	    , _message {std::move(message)}
+	{
+		_handler.add_scheduled();
+	}
+
+	~PublishAction() override
+	{
+		_handler.remove_scheduled();
+	}
+
+	void fire() override
+	{
+		_handler.publish(std::move(_message));
+	}
+
+private:
+	EventHandlerImpl<M>& _handler;
+	std::unique_ptr<M> _message;
+};
+
 }  // namespace detail
 
+class TypeExchange;
+
+/** @brief Publishes & subscribes to one message type of a TypeExchange.
+
+    Bound directly to the exchange's handler for M, so each call skips the
+    type lookup which TypeExchange::publish() and subscribe() perform.
+    Obtain with TypeExchange::channel(); valid for the exchange's lifetime.
+    Cheap to copy.
+ */
+template <typename M>
+class Channel
+{
+public:
+	void publish(M&& message) const;
+
+	/// Publish a message constructed in place from @p args.
+	template <typename... Args>
+	void emplace(Args&&... args) const;
+
+	/// See TypeExchange::subscribe().
+	auto subscribe(MessageCallback<M>&& callback) const -> SubscriptionId;
+
+	/// See TypeExchange::unsubscribe().
+	auto unsubscribe(SubscriptionId id) const -> bool;
+
+private:
+	friend class TypeExchange;
+
+	explicit Channel(detail::EventHandlerImpl<M>& handler)
+	    : _handler {&handler}
+	{}
+
+	detail::EventHandlerImpl<M>* _handler;
+};
+
+template <typename M>
+void Channel<M>::publish(M&& message) const
+{
+	_handler->publish(detail::make_message(std::move(message)));
+}
+
+template <typename M>
+template <typename... Args>
+void Channel<M>::emplace(Args&&... args) const
+{
+	_handler->publish(std::make_unique<M>(std::forward<Args>(args)...));
+}
+
+template <typename M>
+auto Channel<M>::subscribe(MessageCallback<M>&& callback) const -> SubscriptionId
+{
+	return _handler->subscribe(std::move(callback));
+}
+
+template <typename M>
+auto Channel<M>::unsubscribe(SubscriptionId const id) const -> bool
+{
+	return _handler->unsubscribe(id);
+}
+
 /** @Brief Facilitates arbitrary-type message transfer
 
     Allows subscribing to message types and publishing messages of those types
@@ -97,52 +606,564 @@ class TypeExchange
 	using if_rvalue = std::enable_if_t<std::is_rvalue_reference_v<M&&>, R>;
 
 public:
+	using Clock = detail::TimerWheel::Clock;
+
+	TypeExchange() = default;
+	~TypeExchange();
+
+	// Handlers refer back to the exchange
+	TypeExchange(TypeExchange const&) = delete;
+	TypeExchange& operator=(TypeExchange const&) = delete;
+	TypeExchange(TypeExchange&&) = delete;
+	TypeExchange& operator=(TypeExchange&&) = delete;
+
+	/** @brief Publish due timed messages, then deliver all pending messages.
+
+	    Messages published by subscribers during this call are delivered by the
+	    next call.
+	 */
 	void process_messages();
 
+	/** @brief Deliver messages until none remain, including those published by subscribers.
+
+	    Each round delivers the messages pending at its start, visiting only
+	    types which received messages. Cascades of reactions thus complete in
+	    one call instead of one process_messages() call per step.
+
+	    @param max_rounds Upper bound on rounds, so that feedback loops cannot hang the caller.
+	    @return False if messages remain after @p max_rounds rounds.
+	 */
+	auto process_until_idle(std::size_t max_rounds) -> bool;
+
+	/** @brief Block until a message is published, a timed message is due, or @p timeout passes.
+
+	    Only the first publish after a processing round wakes a waiter, so call
+	    process_messages() after every return before waiting again; otherwise
+	    the next wait may sleep while messages are pending. Returns at once if
+	    that first publish happened before this call.
+
+	    Unlike the rest of the exchange, safe to call without synchronizing
+	    with publishers; lock around process_messages() afterwards instead.
+	 */
+	template <typename Rep, typename Period>
+	void wait(std::chrono::duration<Rep, Period> timeout);
+
+	/// wait(), then process_messages().
+	template <typename Rep, typename Period>
+	void wait_and_process(std::chrono::duration<Rep, Period> timeout);
+
+	/** @brief Process messages as they arrive until stop() is called.
+
+	    Sleeps while idle instead of polling process_messages().
+	 */
+	void run();
+
+	/// As run(), but holds @p mutex while processing; for producers which publish under @p mutex.
+	template <typename Mutex>
+	void run(Mutex& mutex);
+
+	/// Make run() return after its current processing round. Thread-safe.
+	void stop();
+
+	/** @brief Descriptor which polls readable while messages await processing, for use with e.g. epoll.
+
+	    Once it polls readable, call wait_and_process() with a zero timeout to
+	    process messages & reset it. Thread-safe.
+
+	    It does not poll readable when a timed message falls due, so bound each
+	    poll by next_deadline() and call wait_and_process() once it passes too.
+
+	    @return -1 if the platform offers no such descriptor, or it could not be created.
+	 */
+	auto wait_handle() -> int;
+
+	/** @brief When the earliest timed message falls due; Clock::time_point::max() if there is none.
+
+	    Set by publish_after() & publish_at(), and refreshed by every processing
+	    call. May be early after cancel(), but never late. Thread-safe.
+	 */
+	auto next_deadline() const -> Clock::time_point;
+
+	/** @brief Call @p callback for every message of type M delivered from now on.
+
+	    Safe to call from any thread, including from within a subscriber while
+	    process_messages() runs. A dispatch already underway keeps delivering to
+	    the subscribers it started with; changes apply from the next dispatch.
+	 */
+	template <typename M>
+	auto subscribe(MessageCallback<M>&& callback) -> SubscriptionId;
+
+	/** @brief Stop delivering messages of type M to a subscriber.
+
+	    Safe to call from any thread; see subscribe(). A subscriber may be
+	    called once more if a dispatch of type M is already underway.
+
+	    @return False if @p id is not subscribed to M.
+	 */
 	template <typename M>
-	void subscribe(MessageCallback<M>&& callback);
+	auto unsubscribe(SubscriptionId id) -> bool;
 
 	template <typename M>
 	auto publish(M&& message) -> if_rvalue<M, void>;
 
+	/// Handle for repeated publishing & subscribing to type M without per-call lookup.
+	template <typename M>
+	auto channel() -> Channel<M>;
+
+	/** @brief Deliver only the latest message of type M per process_messages().
+
+	    For state-like types, e.g. positions, where only the most recent value
+	    matters. Each publish overwrites the pending message instead of queueing,
+	    so memory & dispatch work stay constant regardless of publish rate.
+
+	    @param key Optional; if given, keeps one latest message per key instead,
+	    e.g. per entity ID. Messages are delivered in order of each key's first
+	    publish since the last process_messages().
+	 */
+	template <typename M>
+	void conflate(ConflationKey<M>&& key = {});
+
+	/** @brief Deliver messages of type M to chunks of its subscribers in parallel.
+
+	    For types with many subscribers. Each processing round, the subscribers
+	    are split into chunks of @p chunk_size, which run concurrently on a
+	    thread pool shared by all parallel types. Every subscriber still
+	    receives messages in publish order, and process_messages() returns once
+	    all chunks finish.
+
+	    Only safe for subscribers which share no state with each other, since
+	    they run on several threads at once, and which do not publish from
+	    within the callback. They may still subscribe and unsubscribe.
+	 */
+	template <typename M>
+	void dispatch_in_parallel(std::size_t chunk_size = 16);
+
+	/** @brief Publish @p message once @p delay has passed.
+
+	    The message is published by the first process_messages() call after its
+	    deadline, and delivered by that same call. Never early; the timers'
+	    1 ms resolution may delay it by up to 1 ms.
+
+	    A deadline which has already passed publishes immediately, as publish()
+	    does; the returned handle then cancels nothing.
+	 */
+	template <typename M, typename Rep, typename Period>
+	auto publish_after(std::chrono::duration<Rep, Period> delay, M&& message) -> if_rvalue<M, TimerHandle>;
+
+	/// Publish @p message at @p deadline; see publish_after().
+	template <typename M, typename Duration>
+	auto publish_at(std::chrono::time_point<Clock, Duration> deadline, M&& message) -> if_rvalue<M, TimerHandle>;
+
+	/// Cancel a timed message. @return False if it was already published or cancelled.
+	auto cancel(TimerHandle handle) -> bool;
+
+	/// Estimate the memory held by the exchange, per message type.
+	auto memory_usage() -> MemoryUsage;
+
+	/** @brief Release spare capacity left over from bursts.
+
+	    Subscriptions, channels & settings are unaffected. Call between
+	    processing rounds, as with publish().
+	 */
+	void shrink_to_fit();
+
+	/** @brief Return memory from types which were not processed for at least @p age.
+
+	    Forgets such types entirely if nothing refers to them: no subscribers,
+	    pending or timed messages, channel(), conflate() or
+	    dispatch_in_parallel(). Using them again recreates them. Shrinks the
+	    remaining idle types; see shrink_to_fit().
+
+	    @return Number of types forgotten.
+	 */
+	template <typename Rep, typename Period>
+	auto release_idle(std::chrono::duration<Rep, Period> age) -> std::size_t;
+
 private:
+	using HandlersLock = std::lock_guard<std::mutex>;
+
+	/// Find or create the handler for M. Finding is lock-free once the type exists.
 	template <typename M>
 	auto get_handler() -> detail::EventHandlerImpl<M>&;
 
+	/// As get_handler(), for callers which already hold _type_handlers_mutex.
+	template <typename M>
+	auto get_handler(HandlersLock const& lock) -> detail::EventHandlerImpl<M>&;
+
 	using TypeHandlers = std::unordered_map<std::type_index, std::unique_ptr<detail::EventHandler>>;
+	using HandlerIndex = std::unordered_map<std::type_index, detail::EventHandler*>;
+
+	void process_round(Clock::time_point now);
+
+	/// Created on first use, so that exchanges which never wait never pay for wakeups
+	auto notifier() -> detail::Notifier&;
+
+	void wait_until(Clock::time_point deadline);
+
+	struct NoLock
+	{
+		void lock() {}
+		void unlock() {}
+	};
 
 	TypeHandlers _type_handlers;
+	std::mutex _type_handlers_mutex;  // Subscriptions may change from other threads
+
+	// Copy of _type_handlers without ownership, which lookups read without locking. Changes with _type_handlers.
+	detail::SnapshotCell<HandlerIndex> _handler_index;
+
+	// Exchange-wide, so that IDs stay unique even after release_idle() forgets a type
+	std::atomic<SubscriptionId> _subscription_ids {0};
+
+	detail::TimerWheel _timers;  // Destroyed before the handlers its actions refer to
+
+	detail::PendingHandlers _pending;
+	detail::PendingHandlers _processing;  // Kept to reuse its allocation
+
+	std::unique_ptr<detail::ThreadPool> _pool;  // Created by the first dispatch_in_parallel()
+
+	std::atomic<detail::Notifier*> _notifier {nullptr};
+	std::atomic<Clock::time_point> _next_timer {Clock::time_point::max()};  // Read by wait() without locking
+	std::atomic<bool> _stop_requested {false};
 };
 
+inline TypeExchange::~TypeExchange()
+{
+	delete _notifier.load();
+}
+
 inline void TypeExchange::process_messages()
 {
-	for (auto& [index, handler] : _type_handlers) {
+	auto const now {Clock::now()};
+
+	_timers.advance(now);
+	_next_timer.store(_timers.next_expiry(), std::memory_order_relaxed);
+
+	process_round(now);
+}
+
+inline auto TypeExchange::process_until_idle(std::size_t const max_rounds) -> bool
+{
+	auto const now {Clock::now()};
+
+	_timers.advance(now);
+	_next_timer.store(_timers.next_expiry(), std::memory_order_relaxed);
+
+	for (std::size_t round {0}; round < max_rounds && !_pending.empty(); ++round) {
+		process_round(now);
+	}
+
+	return _pending.empty();
+}
+
+template <typename Rep, typename Period>
+void TypeExchange::wait(std::chrono::duration<Rep, Period> const timeout)
+{
+	auto const now {Clock::now()};
+	auto deadline {Clock::time_point::max()};
+
+	// Compare as floating point, so that e.g. duration::max() cannot overflow
+	if (std::chrono::duration<double>(timeout) < std::chrono::duration<double>(deadline - now)) {
+		deadline = now + std::chrono::ceil<Clock::duration>(timeout);
+	}
+
+	wait_until(deadline);
+}
+
+template <typename Rep, typename Period>
+void TypeExchange::wait_and_process(std::chrono::duration<Rep, Period> const timeout)
+{
+	wait(timeout);
+	process_messages();
+}
+
+inline void TypeExchange::run()
+{
+	NoLock no_lock;
+	run(no_lock);
+}
+
+template <typename Mutex>
+void TypeExchange::run(Mutex& mutex)
+{
+	for (;;) {
+		{
+			std::lock_guard const lock {mutex};
+			process_messages();
+		}
+
+		if (_stop_requested.exchange(false, std::memory_order_acq_rel)) {
+			return;
+		}
+
+		wait_until(Clock::time_point::max());
+	}
+}
+
+inline void TypeExchange::stop()
+{
+	_stop_requested.store(true, std::memory_order_release);
+	notifier().notify();
+}
+
+inline auto TypeExchange::wait_handle() -> int
+{
+	return notifier().handle();
+}
+
+inline auto TypeExchange::next_deadline() const -> Clock::time_point
+{
+	return _next_timer.load(std::memory_order_relaxed);
+}
+
+inline void TypeExchange::wait_until(Clock::time_point const deadline)
+{
+	notifier().wait_until(std::min(deadline, next_deadline()));
+}
+
+inline auto TypeExchange::notifier() -> detail::Notifier&
+{
+	auto* notifier {_notifier.load(std::memory_order_acquire)};
+
+	if (!notifier) {
+		auto created {std::make_unique<detail::Notifier>()};
+
+		// Messages published before the notifier existed did not notify
+		created->notify();
+
+		if (_notifier.compare_exchange_strong(notifier, created.get(), std::memory_order_acq_rel)) {
+			notifier = created.release();
+		}
+	}
+
+	return *notifier;
+}
+
+inline void TypeExchange::process_round(Clock::time_point const now)
+{
+	using std::swap;
+
+	// Handlers which receive messages during this round register in the fresh _pending list
+	swap(_processing, _pending);
+
+	for (auto* handler : _processing) {
+		handler->mark_active(now);
 		handler->process_messages();
 	}
+
+	_processing.clear();
 }
 
 template <typename M>
-void TypeExchange::subscribe(MessageCallback<M>&& callback)
+auto TypeExchange::subscribe(MessageCallback<M>&& callback) -> SubscriptionId
 {
-	auto& handler = get_handler<M>();
+	// Hold the lock throughout, so that release_idle() cannot forget the handler in between
+	HandlersLock const lock {_type_handlers_mutex};
 
-	handler.subscribe(std::move(callback));
+	auto& handler = get_handler<M>(lock);
+
+	return handler.subscribe(std::move(callback));
 }
 
 template <typename M>
-auto TypeExchange::publish(M&& message) -> if_rvalue<M, void>
+auto TypeExchange::unsubscribe(SubscriptionId const id) -> bool
 {
-	using PushType = std::conditional_t<std::is_move_constructible_v<M>, M&&, M const&>;
+	HandlersLock const lock {_type_handlers_mutex};
+
+	auto const it {_type_handlers.find(typeid(M))};
+
+	if (it == _type_handlers.end()) {
+		return false;
+	}
 
-	auto message_ptr = std::make_unique<M>(static_cast<PushType>(message));
+	return static_cast<detail::EventHandlerImpl<M>&>(*it->second).unsubscribe(id);
+}
+
+template <typename M>
+auto TypeExchange::publish(M&& message) -> if_rvalue<M, void>
+{
+	auto message_ptr = detail::make_message(std::move(message));
 
 	auto& handler = get_handler<M>();
 
 	handler.publish(std::move(message_ptr));
 }
 
+template <typename M, typename Rep, typename Period>
+auto TypeExchange::publish_after(std::chrono::duration<Rep, Period> delay, M&& message) -> if_rvalue<M, TimerHandle>
+{
+	return publish_at(Clock::now() + std::chrono::ceil<Clock::duration>(delay), std::move(message));
+}
+
+template <typename M, typename Duration>
+auto TypeExchange::publish_at(std::chrono::time_point<Clock, Duration> deadline, M&& message)
+    -> if_rvalue<M, TimerHandle>
+{
+	auto& handler = get_handler<M>();
+
+	auto const due {std::chrono::ceil<Clock::duration>(deadline)};
+
+	if (due <= Clock::now()) {
+		handler.publish(detail::make_message(std::move(message)));
+		return {};
+	}
+
+	auto action = std::make_unique<detail::PublishAction<M>>(handler, detail::make_message(std::move(message)));
+
+	auto const handle {_timers.schedule(due, std::move(action))};
+
+	// Wake a waiting consumer which would otherwise sleep past this deadline
+	if (due < _next_timer.load(std::memory_order_relaxed)) {
+		_next_timer.store(due, std::memory_order_relaxed);
+
+		if (auto* notifier {_notifier.load(std::memory_order_acquire)}) {
+			notifier->notify();
+		}
+	}
+
+	return handle;
+}
+
+inline auto TypeExchange::cancel(TimerHandle const handle) -> bool
+{
+	return _timers.cancel(handle);
+}
+
+template <typename M>
+auto TypeExchange::channel() -> Channel<M>
+{
+	auto& handler = get_handler<M>();
+
+	handler.pin();
+
+	return Channel<M> {handler};
+}
+
+inline auto TypeExchange::memory_usage() -> MemoryUsage
+{
+	HandlersLock const lock {_type_handlers_mutex};
+
+	MemoryUsage usage;
+	usage.types.reserve(_type_handlers.size());
+
+	// Approximates one node per entry of the type map & of its index
+	auto constexpr entry_bytes {sizeof(TypeHandlers::value_type) + sizeof(HandlerIndex::value_type)
+	                            + 2 * sizeof(void*)};
+
+	for (auto const& [type, handler] : _type_handlers) {
+		auto& type_usage = usage.types.emplace_back(handler->memory_usage());
+		type_usage.handler_bytes += entry_bytes;
+	}
+
+	usage.exchange_bytes = sizeof(*this)
+	                       + (_type_handlers.bucket_count() + _handler_index.read()->bucket_count()) * sizeof(void*)
+	                       + (_pending.capacity() + _processing.capacity()) * sizeof(detail::EventHandler*)
+	                       + _timers.memory_usage();
+
+	return usage;
+}
+
+inline void TypeExchange::shrink_to_fit()
+{
+	HandlersLock const lock {_type_handlers_mutex};
+
+	for (auto const& [type, handler] : _type_handlers) {
+		handler->shrink_to_fit();
+	}
+
+	_type_handlers.rehash(0);
+	_pending.shrink_to_fit();
+	_processing.shrink_to_fit();
+	_timers.shrink_to_fit();
+}
+
+template <typename Rep, typename Period>
+auto TypeExchange::release_idle(std::chrono::duration<Rep, Period> const age) -> std::size_t
+{
+	HandlersLock const lock {_type_handlers_mutex};
+
+	auto const now {Clock::now()};
+	std::vector<std::type_index> released;
+
+	for (auto const& [type, handler] : _type_handlers) {
+		if (now - handler->idle_since() < age) {
+			continue;
+		}
+
+		if (handler->is_releasable()) {
+			released.push_back(type);
+		}
+		else {
+			handler->shrink_to_fit();
+		}
+	}
+
+	_timers.shrink_to_fit();
+
+	if (released.empty()) {
+		return 0;
+	}
+
+	// Unlist the handlers before freeing them
+	_handler_index.update([&released](HandlerIndex& index) {
+		for (auto const& type : released) {
+			index.erase(type);
+		}
+	});
+
+	for (auto const& type : released) {
+		_type_handlers.erase(type);
+	}
+
+	_type_handlers.rehash(0);
+
+	return released.size();
+}
+
+template <typename M>
+void TypeExchange::conflate(ConflationKey<M>&& key)
+{
+	auto& handler = get_handler<M>();
+
+	handler.pin();
+	handler.conflate(std::move(key));
+}
+
+template <typename M>
+void TypeExchange::dispatch_in_parallel(std::size_t const chunk_size)
+{
+	if (!_pool) {
+		// The processing thread runs one chunk itself
+		auto const threads {std::max(std::thread::hardware_concurrency(), 2u) - 1};
+		_pool = std::make_unique<detail::ThreadPool>(threads);
+	}
+
+	auto& handler = get_handler<M>();
+
+	handler.pin();
+	handler.dispatch_in_parallel(*_pool, chunk_size);
+}
+
 template <typename M>
 auto TypeExchange::get_handler() -> detail::EventHandlerImpl<M>&
+{
+	{
+		auto const index {_handler_index.read()};
+		auto const it {index->find(typeid(M))};
+
+		if (it != index->end()) {
+			return static_cast<detail::EventHandlerImpl<M>&>(*it->second);
+		}
+	}
+
+	// Only the first use of a type takes the lock
+	HandlersLock const lock {_type_handlers_mutex};
+
+	return get_handler<M>(lock);
+}
+
+template <typename M>
+auto TypeExchange::get_handler(HandlersLock const&) -> detail::EventHandlerImpl<M>&
 {
 	// operator[] creates a new handler for new indices
 	auto& handler = _type_handlers[typeid(M)];
@@ -152,6 +1173,10 @@ auto TypeExchange::get_handler() -> detail::EventHandlerImpl<M>&
 	// If a handler was just created, the instance pointer is still null
 	if (!handler) {
 		handler = std::make_unique<ImplType>();
+		handler->track_pending(&_pending, &_notifier);
+		handler->share_subscription_ids(&_subscription_ids);
+
+		_handler_index.update([&handler](HandlerIndex& index) { index.emplace(typeid(M), handler.get()); });
 	}
 
 	// Return a reference to the handler instance
@@ -0,0 +1,401 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <cstdio>  // for std::fopen
+#undef _CRT_SECURE_NO_WARNINGS
+
+#include "log-binary.hxx"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include "log.hxx"
+
+namespace project::log::binary {
+
+namespace detail {
+std::atomic<bool> Enabled {false};
+}  // namespace detail
+
+namespace {
+
+using detail::ArgTag;
+using detail::RecordKind;
+
+std::array<char, 8> constexpr file_magic {'T', 'X', 'B', 'L', 'O', 'G', '1', '\n'};
+
+std::size_t constexpr buffer_capacity {64 * 1024};
+
+struct ThreadBuffer
+{
+	std::mutex mutex;
+	std::vector<char> data = std::vector<char>(buffer_capacity);
+	std::size_t used {};
+	std::uint64_t generation {};  // Generation of the log that buffered records belong to
+};
+
+struct State
+{
+	// Guards `file`, `ids`, and writes to `generation`. Acquire after any ThreadBuffer::mutex.
+	std::mutex file_mutex;
+	std::FILE* file {};
+	std::unordered_map<std::string, std::uint32_t> ids;  // Format string content to ID
+
+	// Incremented each time a log is opened, invalidating buffered records & cached IDs.
+	std::atomic<std::uint64_t> generation {0};
+
+	std::mutex buffers_mutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+	~State()
+	{
+		if (file) {
+			std::fclose(file);
+		}
+	}
+};
+
+auto state() -> State&
+{
+	static State instance;
+	return instance;
+}
+
+// Requires buffer.mutex
+void write_buffer(ThreadBuffer& buffer)
+{
+	auto& s {state()};
+
+	if (buffer.used > 0) {
+		std::lock_guard const lock {s.file_mutex};
+
+		if (s.file && buffer.generation == s.generation.load(std::memory_order_relaxed)) {
+			std::fwrite(buffer.data.data(), 1, buffer.used, s.file);
+		}
+	}
+
+	buffer.used = 0;
+}
+
+// Owns the calling thread's buffer & flushes it when the thread exits.
+struct ThreadLocal
+{
+	std::shared_ptr<ThreadBuffer> buffer {std::make_shared<ThreadBuffer>()};
+	std::unique_lock<std::mutex> lock {buffer->mutex, std::defer_lock};
+
+	ThreadLocal()
+	{
+		auto& s {state()};
+		std::lock_guard const registry_lock {s.buffers_mutex};
+		s.buffers.push_back(buffer);
+	}
+
+	~ThreadLocal()
+	{
+		auto& s {state()};
+		{
+			std::lock_guard const buffer_lock {buffer->mutex};
+			write_buffer(*buffer);
+		}
+		std::lock_guard const registry_lock {s.buffers_mutex};
+		s.buffers.erase(std::remove(s.buffers.begin(), s.buffers.end(), buffer), s.buffers.end());
+	}
+};
+
+auto thread_local_buffer() -> ThreadLocal&
+{
+	thread_local ThreadLocal instance;
+	return instance;
+}
+
+// Direct-mapped cache of format string address to ID, so that repeat calls skip the global lock.
+// Keeps its own copy of the content: a different format string may later occupy the same address.
+struct CachedId
+{
+	char const* format {};
+	std::string content;
+	std::uint32_t id {};
+	std::uint64_t generation {};
+};
+
+thread_local std::array<CachedId, 256> id_cache {};
+
+template <typename V>
+auto read(std::FILE* in, V& value) -> bool
+{
+	return std::fread(&value, sizeof(value), 1, in) == 1;
+}
+
+auto read_string(std::FILE* in, std::string& str) -> bool
+{
+	std::uint32_t size {};
+
+	if (!read(in, size)) {
+		return false;
+	}
+
+	str.resize(size);
+	return size == 0 || std::fread(str.data(), 1, size, in) == size;
+}
+
+}  // namespace
+
+auto open(char const* path) -> bool
+{
+	auto& s {state()};
+
+	close();
+
+	std::FILE* file {std::fopen(path, "wb")};
+
+	if (!file) {
+		return false;
+	}
+
+	std::fwrite(file_magic.data(), 1, file_magic.size(), file);
+
+	{
+		std::lock_guard const lock {s.file_mutex};
+		s.file = file;
+		s.ids.clear();
+		s.generation.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	detail::Enabled.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void close()
+{
+	auto& s {state()};
+
+	detail::Enabled.store(false, std::memory_order_relaxed);
+
+	flush();
+
+	std::lock_guard const lock {s.file_mutex};
+
+	if (s.file) {
+		std::fclose(s.file);
+		s.file = nullptr;
+	}
+}
+
+void flush()
+{
+	auto& s {state()};
+
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	{
+		std::lock_guard const lock {s.buffers_mutex};
+		buffers = s.buffers;
+	}
+
+	for (auto const& buffer : buffers) {
+		std::lock_guard const lock {buffer->mutex};
+		write_buffer(*buffer);
+	}
+
+	std::lock_guard const lock {s.file_mutex};
+
+	if (s.file) {
+		std::fflush(s.file);
+	}
+}
+
+namespace detail {
+
+auto format_id(std::string_view const format) -> std::uint32_t
+{
+	auto& s {state()};
+	auto const generation {s.generation.load(std::memory_order_relaxed)};
+
+	auto& cached {id_cache[(reinterpret_cast<std::uintptr_t>(format.data()) >> 3) % id_cache.size()]};
+
+	if (cached.format == format.data() && cached.generation == generation && cached.content == format) {
+		return cached.id;
+	}
+
+	std::lock_guard const lock {s.file_mutex};
+
+	auto [it, inserted] {s.ids.try_emplace(std::string {format}, static_cast<std::uint32_t>(s.ids.size()))};
+
+	if (inserted && s.file) {
+		// Definitions go straight to the file so they always precede buffered entries which use them.
+		auto const size {static_cast<std::uint32_t>(format.size())};
+
+		auto constexpr kind {RecordKind::Format};
+
+		std::fwrite(&kind, sizeof(kind), 1, s.file);
+		std::fwrite(&it->second, sizeof(it->second), 1, s.file);
+		std::fwrite(&size, sizeof(size), 1, s.file);
+		std::fwrite(format.data(), 1, format.size(), s.file);
+	}
+
+	cached.format = format.data();
+	cached.content.assign(format);
+	cached.id = it->second;
+	cached.generation = generation;
+	return it->second;
+}
+
+auto begin_record(std::size_t const size) -> char*
+{
+	auto& local {thread_local_buffer()};
+	auto& buffer {*local.buffer};
+
+	local.lock.lock();
+
+	auto const generation {state().generation.load(std::memory_order_relaxed)};
+
+	if (buffer.generation != generation) {
+		buffer.used = 0;
+		buffer.generation = generation;
+	}
+
+	if (buffer.data.size() - buffer.used < size) {
+		write_buffer(buffer);
+
+		if (buffer.data.size() < size) {
+			buffer.data.resize(size);
+		}
+	}
+
+	return buffer.data.data() + buffer.used;
+}
+
+void end_record(std::size_t const size)
+{
+	auto& local {thread_local_buffer()};
+
+	local.buffer->used += size;
+	local.lock.unlock();
+}
+
+auto timestamp() -> std::uint64_t
+{
+	using namespace std::chrono;
+	return static_cast<std::uint64_t>(duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace detail
+
+auto decode(std::FILE* in, std::FILE* out) -> bool
+{
+	std::array<char, file_magic.size()> magic {};
+
+	if (std::fread(magic.data(), 1, magic.size(), in) != magic.size() || magic != file_magic) {
+		return false;
+	}
+
+	std::unordered_map<std::uint32_t, std::string> formats;
+	std::string str;
+
+	for (RecordKind kind {}; read(in, kind);) {
+		std::uint32_t id {};
+
+		if (kind == RecordKind::Format) {
+			if (!read(in, id) || !read_string(in, str)) {
+				return false;
+			}
+			formats[id] = str;
+			continue;
+		}
+
+		if (kind != RecordKind::Entry) {
+			return false;
+		}
+
+		std::uint8_t level {};
+		std::uint64_t time {};
+		std::uint8_t arg_count {};
+
+		if (!read(in, level) || !read(in, id) || !read(in, time) || !read(in, arg_count)) {
+			return false;
+		}
+
+		auto const format {formats.find(id)};
+
+		if (format == formats.end()) {
+			return false;
+		}
+
+		fmt::dynamic_format_arg_store<fmt::format_context> store;
+
+		for (std::uint8_t i {0}; i < arg_count; ++i) {
+			ArgTag tag {};
+
+			if (!read(in, tag)) {
+				return false;
+			}
+
+			bool ok {false};
+
+			switch (tag) {
+			case ArgTag::Signed: {
+				std::int64_t value {};
+				ok = read(in, value);
+				store.push_back(value);
+			} break;
+			case ArgTag::Unsigned: {
+				std::uint64_t value {};
+				ok = read(in, value);
+				store.push_back(value);
+			} break;
+			case ArgTag::Float: {
+				double value {};
+				ok = read(in, value);
+				store.push_back(value);
+			} break;
+			case ArgTag::Bool: {
+				std::uint8_t value {};
+				ok = read(in, value);
+				store.push_back(value != 0);
+			} break;
+			case ArgTag::Char: {
+				char value {};
+				ok = read(in, value);
+				store.push_back(value);
+			} break;
+			case ArgTag::String: {
+				ok = read_string(in, str);
+				store.push_back(str);  // Copies
+			} break;
+			}
+
+			if (!ok) {
+				return false;
+			}
+		}
+
+		std::string message;
+
+		try {
+			message = fmt::vformat(format->second, store);
+		} catch (fmt::format_error const& e) {
+			message = fmt::format("<{}: \"{}\">", e.what(), format->second);
+		}
+
+		std::uint64_t constexpr ns_per_s {1'000'000'000};
+
+		fmt::print(out,
+		           "{}.{:09} {}: {}\n",
+		           time / ns_per_s,
+		           time % ns_per_s,
+		           level_label(static_cast<Level>(level)),
+		           message);
+	}
+
+	return true;
+}
+
+}  // namespace project::log::binary
@@ -0,0 +1,233 @@
+#ifndef LOG_BINARY_HXX
+#define LOG_BINARY_HXX
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>  // for std::FILE
+#include <cstring>  // for std::memcpy
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <project_dll-export.h>
+
+namespace project::log {
+
+enum class Level;  // Defined in log.hxx
+
+/** @brief Deferred binary logging.
+
+    While a binary log is open, log::trace() and log::debug() do not format
+    their messages. Each call site's format string is registered once, then
+    every call writes only a format ID, a timestamp, and its raw arguments to
+    a per-thread buffer. Buffers are written to the log file in large chunks.
+
+    The app-log-decoder executable (or decode()) turns a binary log back into
+    text after the fact.
+
+    Calls only take the binary path if the format string is a string literal
+    and every argument is an arithmetic type or a string. Other calls fall back
+    to immediate text formatting.
+
+    The file format uses native byte order, so decode on a machine with the
+    same endianness as the one that wrote the log.
+ */
+namespace binary {
+
+namespace detail {
+
+DLL extern std::atomic<bool> Enabled;
+
+// Wire format tags. Records begin with a RecordKind; entry arguments begin with an ArgTag.
+enum class RecordKind : std::uint8_t
+{
+	Format = 0,
+	Entry = 1,
+};
+
+enum class ArgTag : std::uint8_t
+{
+	Signed = 0,
+	Unsigned = 1,
+	Float = 2,
+	Bool = 3,
+	Char = 4,
+	String = 5,
+};
+
+template <typename T>
+using bare_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+template <typename T>
+bool constexpr is_string_v = std::is_same_v<std::decay_t<T>, char const*> || std::is_same_v<std::decay_t<T>, char*>
+                             || std::is_same_v<bare_t<T>, std::string> || std::is_same_v<bare_t<T>, std::string_view>;
+
+template <typename T>
+bool constexpr is_encodable_v = std::is_arithmetic_v<bare_t<T>> || is_string_v<T>;
+
+// String literals and const arrays are the only format strings whose content is fixed for as long as they exist.
+// Mutable char buffers may be rewritten at the same address, so only const arrays qualify.
+template <typename T>
+bool constexpr is_literal_v = std::is_array_v<std::remove_reference_t<T>>
+                              && std::is_same_v<std::remove_extent_t<std::remove_reference_t<T>>, char const>;
+
+/** @brief Find or assign the ID of a format string, writing its definition to the log on first use.
+
+    IDs are assigned by content. Lookups are cached by address, but a cached
+    ID is only reused while the content there still matches, since const
+    local arrays in different scopes can occupy the same address.
+ */
+DLL auto format_id(std::string_view format) -> std::uint32_t;
+
+/// Reserve @p size bytes in the calling thread's buffer.
+DLL auto begin_record(std::size_t size) -> char*;
+
+/// Commit the @p size bytes reserved by begin_record().
+DLL void end_record(std::size_t size);
+
+DLL auto timestamp() -> std::uint64_t;
+
+template <typename T>
+auto constexpr fixed_size() -> std::size_t
+{
+	using U = bare_t<T>;
+
+	if constexpr (is_string_v<T>) {
+		return sizeof(ArgTag) + sizeof(std::uint32_t);
+	}
+	else if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+		return sizeof(ArgTag) + 1;
+	}
+	else {
+		return sizeof(ArgTag) + 8;
+	}
+}
+
+template <typename T>
+auto string_of(T const& value) -> std::string_view
+{
+	if constexpr (std::is_pointer_v<bare_t<T>>) {
+		return value ? std::string_view {value} : std::string_view {};
+	}
+	else {
+		return std::string_view {value};
+	}
+}
+
+template <typename T>
+auto variable_size(T const& value) -> std::size_t
+{
+	if constexpr (is_string_v<T>) {
+		return string_of(value).size();
+	}
+	else {
+		(void) value;
+		return 0;
+	}
+}
+
+template <typename V>
+auto put(char* out, V const& value) -> char*
+{
+	std::memcpy(out, &value, sizeof(value));
+	return out + sizeof(value);
+}
+
+template <typename T>
+auto put_arg(char* out, T const& value) -> char*
+{
+	using U = bare_t<T>;
+
+	if constexpr (is_string_v<T>) {
+		auto const str {string_of(value)};
+		out = put(out, ArgTag::String);
+		out = put(out, static_cast<std::uint32_t>(str.size()));
+		std::memcpy(out, str.data(), str.size());
+		return out + str.size();
+	}
+	else if constexpr (std::is_same_v<U, bool>) {
+		out = put(out, ArgTag::Bool);
+		return put(out, static_cast<std::uint8_t>(value));
+	}
+	else if constexpr (std::is_same_v<U, char>) {
+		out = put(out, ArgTag::Char);
+		return put(out, value);
+	}
+	else if constexpr (std::is_floating_point_v<U>) {
+		out = put(out, ArgTag::Float);
+		return put(out, static_cast<double>(value));
+	}
+	else if constexpr (std::is_signed_v<U>) {
+		out = put(out, ArgTag::Signed);
+		return put(out, static_cast<std::int64_t>(value));
+	}
+	else {
+		out = put(out, ArgTag::Unsigned);
+		return put(out, static_cast<std::uint64_t>(value));
+	}
+}
+
+}  // namespace detail
+
+/// True if @p Format and @p Args can be written to a binary log.
+template <typename Format, typename... Args>
+bool constexpr is_loggable_v = detail::is_literal_v<Format> && (detail::is_encodable_v<Args> && ...)
+                               && sizeof...(Args) < 256;
+
+/** @brief Open @p path as the binary log, replacing any open binary log.
+    @return False if the file cannot be opened.
+ */
+DLL auto open(char const* path) -> bool;
+
+/// Flush all buffered records, then close the binary log.
+DLL void close();
+
+/// Write all buffered records to the binary log.
+DLL void flush();
+
+inline auto is_open() -> bool
+{
+	return detail::Enabled.load(std::memory_order_relaxed);
+}
+
+/// Write one log entry. Does not check the log level.
+template <typename Format, typename... Args>
+void write(Level level, Format const& format, Args const&... args)
+{
+	static_assert(is_loggable_v<Format const&, Args...>, "Arguments are not binary-loggable");
+
+	auto const id {detail::format_id(std::string_view {format})};
+	auto const time {detail::timestamp()};
+
+	std::size_t constexpr header_size {sizeof(detail::RecordKind) + sizeof(std::uint8_t) + sizeof(id) + sizeof(time)
+	                                   + sizeof(std::uint8_t)};
+	std::size_t constexpr fixed_args_size {(std::size_t {0} + ... + detail::fixed_size<Args>())};
+
+	std::size_t const size {header_size + fixed_args_size + (std::size_t {0} + ... + detail::variable_size(args))};
+
+	char* out {detail::begin_record(size)};
+
+	out = detail::put(out, detail::RecordKind::Entry);
+	out = detail::put(out, static_cast<std::uint8_t>(level));
+	out = detail::put(out, id);
+	out = detail::put(out, time);
+	out = detail::put(out, static_cast<std::uint8_t>(sizeof...(Args)));
+	((out = detail::put_arg(out, args)), ...);
+
+	detail::end_record(size);
+}
+
+/** @brief Convert a binary log to text.
+
+    Each entry becomes one line: "<seconds>.<nanoseconds> <Level>: <message>"
+    where the timestamp is time since the system clock epoch.
+
+    @return False if @p in is not a binary log or is truncated.
+ */
+DLL auto decode(std::FILE* in, std::FILE* out) -> bool;
+
+}  // namespace binary
+
+}  // namespace project::log
+
+#endif  // LOG_BINARY_HXX
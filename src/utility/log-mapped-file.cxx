@@ -0,0 +1,216 @@
+#include "log-mapped-file.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace project::log {
+
+MappedFileSink::MappedFileSink(std::filesystem::path path, std::size_t const max_size, std::size_t const max_files)
+    : _path {std::move(path)}
+    , _max_size {max_size}
+    , _max_files {max_files}
+{
+	// Keep the previous run's log rather than overwriting it
+	std::error_code error;
+	auto const existing {std::filesystem::file_size(_path, error)};
+
+	if (!error && existing > 0) {
+		shift_files();
+	}
+
+	open();
+}
+
+MappedFileSink::~MappedFileSink()
+{
+	close();
+}
+
+void MappedFileSink::write(Level, std::string_view const line)
+{
+	std::lock_guard const lock {_mutex};
+
+	auto const size {std::min(line.size(), _max_size)};
+
+	if (_data && _used + size > _max_size) {
+		rotate();
+	}
+
+	if (!_data) {
+		return;
+	}
+
+	std::memcpy(_data + _used, line.data(), size);
+	_used += size;
+}
+
+void MappedFileSink::flush()
+{
+	std::lock_guard const lock {_mutex};
+
+	if (!_data) {
+		return;
+	}
+
+#ifdef _WIN32
+	FlushViewOfFile(_data, _used);
+#else
+	msync(_data, _used, MS_ASYNC);
+#endif
+}
+
+auto MappedFileSink::is_open() const -> bool
+{
+	std::lock_guard const lock {_mutex};
+	return _data != nullptr;
+}
+
+void MappedFileSink::rotate()
+{
+	close();
+	shift_files();
+	open();
+}
+
+void MappedFileSink::shift_files()
+{
+	if (_max_files == 0) {
+		return;
+	}
+
+	std::error_code ignored;
+
+	auto const rotated = [this](std::size_t const index) {
+		auto path {_path};
+		path += "." + std::to_string(index);
+		return path;
+	};
+
+	std::filesystem::remove(rotated(_max_files), ignored);
+
+	for (auto index {_max_files - 1}; index > 0; --index) {
+		std::filesystem::rename(rotated(index), rotated(index + 1), ignored);
+	}
+
+	std::filesystem::rename(_path, rotated(1), ignored);
+}
+
+#ifdef _WIN32
+
+void MappedFileSink::open()
+{
+	if (_max_size == 0) {
+		return;
+	}
+
+	HANDLE const file {
+	    CreateFileW(_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, 0, nullptr)};
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+
+	auto const size {static_cast<unsigned long long>(_max_size)};
+
+	// Mapping a size larger than the file extends the file
+	HANDLE const mapping {CreateFileMappingW(
+	    file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr)};
+
+	void* data {mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, _max_size) : nullptr};
+
+	if (!data) {
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return;
+	}
+
+	_file = file;
+	_mapping = mapping;
+	_data = static_cast<char*>(data);
+	_used = 0;
+}
+
+void MappedFileSink::close()
+{
+	if (!_data) {
+		return;
+	}
+
+	UnmapViewOfFile(_data);
+	CloseHandle(_mapping);
+
+	// Drop the unwritten remainder of the mapping
+	LARGE_INTEGER end;
+	end.QuadPart = static_cast<LONGLONG>(_used);
+	SetFilePointerEx(_file, end, nullptr, FILE_BEGIN);
+	SetEndOfFile(_file);
+	CloseHandle(_file);
+
+	_data = nullptr;
+	_mapping = nullptr;
+	_file = nullptr;
+}
+
+#else
+
+void MappedFileSink::open()
+{
+	if (_max_size == 0) {
+		return;
+	}
+
+	int const file {::open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+
+	if (file < 0) {
+		return;
+	}
+
+	void* data {MAP_FAILED};
+
+	if (ftruncate(file, static_cast<off_t>(_max_size)) == 0) {
+		data = mmap(nullptr, _max_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	}
+
+	if (data == MAP_FAILED) {
+		::close(file);
+		return;
+	}
+
+	_file = file;
+	_data = static_cast<char*>(data);
+	_used = 0;
+}
+
+void MappedFileSink::close()
+{
+	if (!_data) {
+		return;
+	}
+
+	munmap(_data, _max_size);
+
+	// Drop the unwritten remainder of the mapping
+	(void) ftruncate(_file, static_cast<off_t>(_used));
+	::close(_file);
+
+	_data = nullptr;
+	_file = -1;
+}
+
+#endif
+
+}  // namespace project::log
@@ -0,0 +1,71 @@
+#ifndef LOG_MAPPED_FILE_HXX
+#define LOG_MAPPED_FILE_HXX
+
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+
+#include <project_dll-export.h>
+
+#include "log.hxx"
+
+namespace project::log {
+
+/** @brief Sink which copies lines into a memory-mapped file, rotating by size.
+
+    Each line is a memcpy() into the mapped region rather than a stdio call.
+    When the next line would not fit in @p max_size bytes, the file is
+    truncated to its written length and rotated: @p path becomes path.1,
+    path.1 becomes path.2, and so on, keeping @p max_files rotated files.
+    With @p max_files of 0, the file restarts empty instead.
+
+    A non-empty file already at @p path, e.g. from a previous run, is
+    rotated the same way on construction rather than overwritten.
+
+    Lines longer than @p max_size are truncated.
+
+@code
+log::add_sink(std::make_shared<log::MappedFileSink>("app.log", 16 << 20, 4));
+@endcode
+ */
+class DLL MappedFileSink : public Sink
+{
+public:
+	MappedFileSink(std::filesystem::path path, std::size_t max_size, std::size_t max_files = 1);
+	~MappedFileSink() override;
+
+	MappedFileSink(MappedFileSink const&) = delete;
+	MappedFileSink& operator=(MappedFileSink const&) = delete;
+
+	void write(Level level, std::string_view line) override;
+	void flush() override;
+
+	/// False if the file could not be created or mapped. Writes are then ignored.
+	auto is_open() const -> bool;
+
+private:
+	void open();
+	void close();
+	void rotate();
+	void shift_files();  // Rename path to path.1 & so on, dropping the oldest
+
+	std::filesystem::path const _path;
+	std::size_t const _max_size;
+	std::size_t const _max_files;
+
+	mutable std::mutex _mutex;
+	char* _data {};
+	std::size_t _used {};
+
+#ifdef _WIN32
+	void* _file {};
+	void* _mapping {};
+#else
+	int _file {-1};
+#endif
+};
+
+}  // namespace project::log
+
+#endif  // LOG_MAPPED_FILE_HXX
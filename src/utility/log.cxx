@@ -4,16 +4,39 @@
 #include <cctype>
 #include <cstdio>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
+
+#include "snapshot.hxx"
 
 namespace project::log {
 
 namespace detail {
-Level LogLevel {Level::Info};
-std::FILE* LogTarget {stderr};  // https://en.cppreference.com/w/cpp/io/c/FILE
+std::atomic<Level> LogLevel {Level::Info};
+std::atomic<std::FILE*> LogTarget {stderr};  // https://en.cppreference.com/w/cpp/io/c/FILE
 }  // namespace detail
 
+namespace {
+
+using SinkList = std::vector<std::shared_ptr<Sink>>;
+
+// Writers replace the whole list, so readers iterate a snapshot without taking a lock.
+::project::detail::SnapshotCell<SinkList> Sinks;
+std::atomic<bool> HasSinks {false};
+
+template <typename Modify>
+void modify_sinks(Modify&& modify)
+{
+	Sinks.update([&modify](SinkList& sinks) {
+		modify(sinks);
+		HasSinks.store(!sinks.empty(), std::memory_order_relaxed);
+	});
+}
+
+}  // namespace
+
 auto level_from(std::string_view const level) -> Level
 {
 	std::string level_lowercase;
@@ -44,24 +67,110 @@ auto level_from(std::string_view const level) -> Level
 
 void set_level(Level const level)
 {
-	detail::LogLevel = level;
+	detail::LogLevel.store(level, std::memory_order_relaxed);
 }
 
 auto get_level() -> Level
 {
-	return detail::LogLevel;
+	return detail::LogLevel.load(std::memory_order_relaxed);
 }
 
 void set_target(std::FILE* target)
 {
-	detail::LogTarget = target;
+	detail::LogTarget.store(target, std::memory_order_relaxed);
 }
 
 auto get_target() -> std::FILE*
 {
-	return detail::LogTarget;
+	return detail::LogTarget.load(std::memory_order_relaxed);
 }
 
+Sink::~Sink() = default;
+
+void Sink::flush()
+{}
+
+void Sink::set_level(Level const level)
+{
+	_level.store(level, std::memory_order_relaxed);
+}
+
+auto Sink::get_level() const -> Level
+{
+	return _level.load(std::memory_order_relaxed);
+}
+
+auto Sink::accepts(Level const level) const -> bool
+{
+	return level != Level::None && get_level() >= level;
+}
+
+FileSink::FileSink(std::FILE* file)
+    : _file {file}
+{}
+
+void FileSink::write(Level, std::string_view const line)
+{
+	std::fwrite(line.data(), 1, line.size(), _file);
+}
+
+void FileSink::flush()
+{
+	std::fflush(_file);
+}
+
+void add_sink(std::shared_ptr<Sink> sink)
+{
+	modify_sinks([&sink](SinkList& sinks) { sinks.push_back(std::move(sink)); });
+}
+
+void remove_sink(std::shared_ptr<Sink> const& sink)
+{
+	modify_sinks([&sink](SinkList& sinks) { sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end()); });
+}
+
+void clear_sinks()
+{
+	modify_sinks([](SinkList& sinks) { sinks.clear(); });
+}
+
+void flush()
+{
+	if (auto* target {get_target()}) {
+		std::fflush(target);
+	}
+
+	auto const sinks {Sinks.read()};
+
+	for (auto const& sink : *sinks) {
+		sink->flush();
+	}
+}
+
+namespace detail {
+
+void write(Level const level, std::string_view const line)
+{
+	if (auto* target {get_target()}) {
+		// A single fwrite() keeps concurrent lines whole
+		std::fwrite(line.data(), 1, line.size(), target);
+	}
+
+	if (!HasSinks.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	auto const sinks {Sinks.read()};
+
+	for (auto const& sink : *sinks) {
+		if (sink->accepts(level)) {
+			sink->write(level, line);
+		}
+	}
+}
+
+}  // namespace detail
+
 void print_enabled_levels()
 {
 	// clang-format off
@@ -83,7 +192,7 @@ void print_enabled_levels()
 
 	char const* msg_ptr {levels.data()};
 
-	switch (detail::LogLevel) {
+	switch (get_level()) {
 	case Level::Error:   levels[error_end]   = '\0'; break;
 	case Level::Warning: levels[warning_end] = '\0'; break;
 	case Level::Info:    levels[info_end]    = '\0'; break;
@@ -93,7 +202,9 @@ void print_enabled_levels()
 	}
 	// clang-format on
 
-	fmt::print(detail::LogTarget, "Logging: {}\n", msg_ptr);
+	if (auto* target {get_target()}) {
+		fmt::print(target, "Logging: {}\n", msg_ptr);
+	}
 }
 
 }  // namespace project::log
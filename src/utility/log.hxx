@@ -1,7 +1,15 @@
 #ifndef LOG_HXX
 #define LOG_HXX
 
+#include <algorithm>  // for std::min
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>  // for std::FILE
+#include <iterator>  // for std::back_inserter
+#include <limits>
+#include <memory>
+#include <string>
 #include <string_view>
 #include <utility>  // for std::forward
 
@@ -9,6 +17,8 @@
 
 #include <project_dll-export.h>
 
+#include "log-binary.hxx"
+
 namespace project::log {
 
 /** @brief Logging severity level.
@@ -34,8 +44,8 @@ enum class Level
 };
 
 namespace detail {
-DLL extern Level LogLevel;
-DLL extern std::FILE* LogTarget;
+DLL extern std::atomic<Level> LogLevel;
+DLL extern std::atomic<std::FILE*> LogTarget;
 }  // namespace detail
 
 /** @brief Convert a string to a logging severity level.
@@ -66,10 +76,62 @@ auto constexpr level_label(Level level) -> std::string_view
 DLL void set_level(Level level);
 DLL auto get_level() -> Level;
 
-/// Set the log output target.
+/// Set the log output target. nullptr disables the target, e.g. to log only to sinks.
 DLL void set_target(std::FILE* target);
 DLL auto get_target() -> std::FILE*;
 
+/** @brief Additional log output.
+
+    Each message is formatted once, then written to the log target and to
+    every sink whose own level admits it. The global log level still applies
+    first, so set it to the least-severe level any sink needs.
+
+    write() may be called concurrently from several threads.
+ */
+class DLL Sink
+{
+public:
+	virtual ~Sink();
+
+	/// Write one formatted line, including its trailing newline.
+	virtual void write(Level level, std::string_view line) = 0;
+	virtual void flush();
+
+	/// Ignore messages less-severe than \p level. Defaults to Level::Trace.
+	void set_level(Level level);
+	auto get_level() const -> Level;
+
+	auto accepts(Level level) const -> bool;
+
+private:
+	std::atomic<Level> _level {Level::Trace};
+};
+
+/// Sink which writes to a std::FILE*. Does not own the file.
+class DLL FileSink : public Sink
+{
+public:
+	explicit FileSink(std::FILE* file);
+
+	void write(Level level, std::string_view line) override;
+	void flush() override;
+
+private:
+	std::FILE* _file;
+};
+
+DLL void add_sink(std::shared_ptr<Sink> sink);
+DLL void remove_sink(std::shared_ptr<Sink> const& sink);
+DLL void clear_sinks();
+
+/// Flush the log target and all sinks.
+DLL void flush();
+
+namespace detail {
+/// Write a formatted line to the log target and all sinks which accept \p level.
+DLL void write(Level level, std::string_view line);
+}  // namespace detail
+
 /// Print all active log levels given the current global log level.
 DLL void print_enabled_levels();
 
@@ -77,13 +139,43 @@ DLL void print_enabled_levels();
 #define ENABLE_LOGGING 0
 #endif
 
+/** @brief Least-severe level compiled into the program, e.g. Info.
+
+    Messages less severe than PROJECT_LOG_MIN_LEVEL are removed at compile
+    time regardless of the runtime log level. The PROJECT_LOG_* macros below
+    additionally skip evaluating their arguments.
+ */
+#ifndef PROJECT_LOG_MIN_LEVEL
+#define PROJECT_LOG_MIN_LEVEL Trace
+#endif
+
+inline Level constexpr MinLevel {Level::PROJECT_LOG_MIN_LEVEL};
+
+/// True if messages of \p level are compiled in.
+auto constexpr is_compiled(Level level) -> bool
+{
+	return ENABLE_LOGGING && level != Level::None && level <= MinLevel;
+}
+
+/// True if messages of \p level are compiled in and pass the global log level.
+inline auto is_enabled(Level level) -> bool
+{
+	return is_compiled(level) && detail::LogLevel.load(std::memory_order_relaxed) >= level;
+}
+
 /// Emit a log message.
 template <typename... Args>
 void print(Level level, Args&&... args)
 {
 #if ENABLE_LOGGING
-	if (detail::LogLevel >= level) {
-		fmt::print(detail::LogTarget, "{}: {}\n", level_label(level), fmt::format(std::forward<Args>(args)...));
+	if (is_enabled(level)) {
+		// Format once for the target & all sinks
+		std::string line {level_label(level)};
+		line += ": ";
+		fmt::format_to(std::back_inserter(line), std::forward<Args>(args)...);
+		line += '\n';
+
+		detail::write(level, line);
 	}
 #else
 	(void) level;
@@ -91,15 +183,36 @@ void print(Level level, Args&&... args)
 #endif
 }
 
+namespace detail {
+/// Emit a message via the binary log if it is open and takes \p level & \p args, otherwise via print().
+template <typename... Args>
+void emit(Level level, Args&&... args)
+{
+#if ENABLE_LOGGING
+	if constexpr (binary::is_loggable_v<Args...>) {
+		if (level >= Level::Debug && binary::is_open()) {
+			if (is_enabled(level)) {
+				binary::write(level, args...);
+			}
+			return;
+		}
+	}
+#endif
+	print(level, std::forward<Args>(args)...);
+}
+}  // namespace detail
+
 /// Emit an error message.
 template <typename... Args>
 void error(Args&&... args)
 {
 #if ENABLE_LOGGING
-	print(Level::Error, std::forward<Args>(args)...);
-#else
-	((void) args, ...);
+	if constexpr (is_compiled(Level::Error)) {
+		print(Level::Error, std::forward<Args>(args)...);
+		return;
+	}
 #endif
+	((void) args, ...);
 }
 
 /// Emit a warning message.
@@ -107,10 +220,12 @@ template <typename... Args>
 void warning(Args&&... args)
 {
 #if ENABLE_LOGGING
-	print(Level::Warning, std::forward<Args>(args)...);
-#else
-	((void) args, ...);
+	if constexpr (is_compiled(Level::Warning)) {
+		print(Level::Warning, std::forward<Args>(args)...);
+		return;
+	}
 #endif
+	((void) args, ...);
 }
 
 /// Emit an informational message.
@@ -118,34 +233,150 @@ template <typename... Args>
 void info(Args&&... args)
 {
 #if ENABLE_LOGGING
-	print(Level::Info, std::forward<Args>(args)...);
-#else
-	((void) args, ...);
+	if constexpr (is_compiled(Level::Info)) {
+		print(Level::Info, std::forward<Args>(args)...);
+		return;
+	}
 #endif
+	((void) args, ...);
 }
 
-/// Emit a debugging message.
+/// Emit a debugging message. Deferred while a binary log is open; see log-binary.hxx.
 template <typename... Args>
 void debug(Args&&... args)
 {
 #if ENABLE_LOGGING
-	print(Level::Debug, std::forward<Args>(args)...);
-#else
-	((void) args, ...);
+	if constexpr (is_compiled(Level::Debug)) {
+		detail::emit(Level::Debug, std::forward<Args>(args)...);
+		return;
+	}
 #endif
+	((void) args, ...);
 }
 
-/// Emit a trace message.
+/// Emit a trace message. Deferred while a binary log is open; see log-binary.hxx.
 template <typename... Args>
 void trace(Args&&... args)
 {
 #if ENABLE_LOGGING
-	print(Level::Trace, std::forward<Args>(args)...);
-#else
-	((void) args, ...);
+	if constexpr (is_compiled(Level::Trace)) {
+		detail::emit(Level::Trace, std::forward<Args>(args)...);
+		return;
+	}
 #endif
+	((void) args, ...);
+}
+
+/// Per-call-site state for print_every_n(). Lock-free.
+class EveryN
+{
+public:
+	/// True for the 1st, (n+1)th, (2n+1)th... call.
+	auto should_log(std::uint64_t n) noexcept -> bool
+	{
+		return _count.fetch_add(1, std::memory_order_relaxed) % (n ? n : 1) == 0;
+	}
+
+private:
+	std::atomic<std::uint64_t> _count {0};
+};
+
+/// Per-call-site state for print_at_most(). Lock-free.
+class AtMost
+{
+public:
+	/// True if at least 1 / \p per_second seconds have passed since the last call which returned true.
+	auto should_log(double per_second) noexcept -> bool
+	{
+		using namespace std::chrono;
+
+		if (!(per_second > 0)) {
+			return false;
+		}
+
+		auto const now {duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count()};
+		auto next {_next.load(std::memory_order_relaxed)};
+
+		if (now < next) {
+			return false;
+		}
+
+		// Tiny rates would overflow the conversion & the addition; a century is as good as never
+		double constexpr max_interval {100.0 * 365 * 24 * 60 * 60 * 1e9};
+		auto const interval {static_cast<std::int64_t>(std::min(1e9 / per_second, max_interval))};
+
+		// Only one of several racing callers wins the slot.
+		return _next.compare_exchange_strong(next, now + interval, std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<std::int64_t> _next {std::numeric_limits<std::int64_t>::min()};
+};
+
+/// Emit every \p n th message passing through \p site. Debug & trace messages are deferred like debug() & trace().
+template <typename... Args>
+void print_every_n(EveryN& site, std::uint64_t n, Level level, Args&&... args)
+{
+	if (is_enabled(level) && site.should_log(n)) {
+		detail::emit(level, std::forward<Args>(args)...);
+	}
+}
+
+/// Emit at most \p per_second messages per second passing through \p site. Debug & trace messages are deferred like
+/// debug() & trace().
+template <typename... Args>
+void print_at_most(AtMost& site, double per_second, Level level, Args&&... args)
+{
+	if (is_enabled(level) && site.should_log(per_second)) {
+		detail::emit(level, std::forward<Args>(args)...);
+	}
 }
 
 }  // namespace project::log
 
+/** @brief Call-site logging macros.
+
+    Unlike the log:: functions, these do not evaluate their arguments unless
+    the message is compiled in (see PROJECT_LOG_MIN_LEVEL) and passes the
+    global log level. \p level is a log::Level enumerator name, e.g. Warning.
+    Debug & trace messages go to the binary log while it is open, as with
+    log::debug() & log::trace().
+
+    PROJECT_LOG_EVERY_N and PROJECT_LOG_AT_MOST keep their rate-limiting state
+    in a static local, so each call site is limited independently.
+@code
+PROJECT_LOG(Trace, "tick {}", expensive());
+PROJECT_LOG_EVERY_N(Warning, 1000, "queue depth {}", depth);
+PROJECT_LOG_AT_MOST(Info, 2.0, "still waiting on {}", name);
+@endcode
+ */
+#define PROJECT_LOG(level, ...) \
+	do { \
+		if constexpr (::project::log::is_compiled(::project::log::Level::level)) { \
+			if (::project::log::is_enabled(::project::log::Level::level)) { \
+				::project::log::detail::emit(::project::log::Level::level, __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+#define PROJECT_LOG_EVERY_N(level, n, ...) \
+	do { \
+		if constexpr (::project::log::is_compiled(::project::log::Level::level)) { \
+			static ::project::log::EveryN project_log_site_; \
+			if (::project::log::is_enabled(::project::log::Level::level) && project_log_site_.should_log(n)) { \
+				::project::log::detail::emit(::project::log::Level::level, __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
+#define PROJECT_LOG_AT_MOST(level, per_second, ...) \
+	do { \
+		if constexpr (::project::log::is_compiled(::project::log::Level::level)) { \
+			static ::project::log::AtMost project_log_site_; \
+			if (::project::log::is_enabled(::project::log::Level::level) && project_log_site_.should_log(per_second)) { \
+				::project::log::detail::emit(::project::log::Level::level, __VA_ARGS__); \
+			} \
+		} \
+	} while (false)
+
 #endif
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#define ENABLE_LOGGING 1
+#include <log.hxx>
+#undef ENABLE_LOGGING
+
+using namespace project;
+
+namespace {
+struct NotEncodable
+{};
+
+// Each keeps its format in a const array on the stack, so consecutive calls can see both at one address
+[[gnu::noinline]] void trace_first(int const value)
+{
+	char const format[] {"first {}"};
+	log::trace(format, value);
+}
+
+[[gnu::noinline]] void trace_other(int const value)
+{
+	char const format[] {"other {}"};
+	log::trace(format, value);
+}
+}  // namespace
+
+template <>
+struct fmt::formatter<NotEncodable> : fmt::formatter<std::string_view>
+{
+	auto format(NotEncodable const&, format_context& ctx) const
+	{
+		return fmt::formatter<std::string_view>::format("not-encodable", ctx);
+	}
+};
+
+class LogBinary : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		log::set_target(stderr);
+		log::set_level(log::Level::Trace);
+		ASSERT_TRUE(log::binary::open(_path.string().c_str()));
+	}
+
+	void TearDown() override
+	{
+		log::binary::close();
+		log::set_level(log::Level::None);
+		std::filesystem::remove(_path);
+	}
+
+	auto decode() -> std::string
+	{
+		log::binary::close();
+
+		std::FILE* in {std::fopen(_path.string().c_str(), "rb")};
+		std::FILE* out {std::tmpfile()};
+
+		EXPECT_TRUE(log::binary::decode(in, out));
+
+		std::string result(static_cast<std::size_t>(std::ftell(out)), '\0');
+		std::rewind(out);
+		result.resize(std::fread(result.data(), 1, result.size(), out));
+
+		std::fclose(in);
+		std::fclose(out);
+		return result;
+	}
+
+	std::filesystem::path _path {std::filesystem::temp_directory_path() / "unit-project-log-binary.bin"};
+};
+
+TEST(LogBinaryTraits, loggable)
+{
+	EXPECT_TRUE((log::binary::is_loggable_v<char const (&)[3]>));
+	EXPECT_TRUE((log::binary::is_loggable_v<char const (&)[3], int, double, char const*, std::string const&>));
+	EXPECT_FALSE((log::binary::is_loggable_v<std::string const&>));
+	EXPECT_FALSE((log::binary::is_loggable_v<char const*>));
+	EXPECT_FALSE((log::binary::is_loggable_v<char const (&)[3], NotEncodable>));
+
+	// Mutable buffers are not literals: their content can change at the same address
+	EXPECT_FALSE((log::binary::is_loggable_v<char (&)[3]>));
+	EXPECT_FALSE((log::binary::is_loggable_v<char (&)[3], int>));
+}
+
+TEST_F(LogBinary, is_open)
+{
+	ASSERT_TRUE(log::binary::is_open());
+	log::binary::close();
+	ASSERT_FALSE(log::binary::is_open());
+}
+
+TEST_F(LogBinary, open_invalid_path)
+{
+	log::binary::close();
+	ASSERT_FALSE(log::binary::open("/nonexistent-directory/log.bin"));
+	ASSERT_FALSE(log::binary::is_open());
+}
+
+TEST_F(LogBinary, trace_not_formatted)
+{
+	::testing::internal::CaptureStderr();
+	log::trace("{} {}", "message", 1);
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_TRUE(result.empty());
+}
+
+TEST_F(LogBinary, decode_trace)
+{
+	log::trace("{} {}", "message", 1);
+	ASSERT_NE(std::string::npos, decode().find(" Trace: message 1\n"));
+}
+
+TEST_F(LogBinary, decode_debug)
+{
+	log::debug("message");
+	ASSERT_NE(std::string::npos, decode().find(" Debug: message\n"));
+}
+
+TEST_F(LogBinary, macros_and_rate_limits_deferred)
+{
+	log::EveryN every_n;
+	log::AtMost at_most;
+
+	::testing::internal::CaptureStderr();
+	PROJECT_LOG(Trace, "macro {}", 1);
+	PROJECT_LOG_EVERY_N(Debug, 10, "every n {}", 2);
+	PROJECT_LOG_AT_MOST(Trace, 1.0, "at most {}", 3);
+	log::print_every_n(every_n, 10, log::Level::Trace, "print every n {}", 4);
+	log::print_at_most(at_most, 1.0, log::Level::Debug, "print at most {}", 5);
+	ASSERT_TRUE(::testing::internal::GetCapturedStderr().empty());
+
+	std::string const result {decode()};
+	ASSERT_NE(std::string::npos, result.find(" Trace: macro 1\n"));
+	ASSERT_NE(std::string::npos, result.find(" Debug: every n 2\n"));
+	ASSERT_NE(std::string::npos, result.find(" Trace: at most 3\n"));
+	ASSERT_NE(std::string::npos, result.find(" Trace: print every n 4\n"));
+	ASSERT_NE(std::string::npos, result.find(" Debug: print at most 5\n"));
+}
+
+TEST_F(LogBinary, decode_argument_types)
+{
+	std::string const str {"str"};
+	std::string_view const view {"view"};
+
+	log::trace("{} {} {} {} {} {:.2f} {} {}", -1, 2u, 'c', true, -3LL, 0.5, str, view);
+	ASSERT_NE(std::string::npos, decode().find("Trace: -1 2 c true -3 0.50 str view\n"));
+}
+
+TEST_F(LogBinary, decode_order)
+{
+	for (int i {0}; i < 3; ++i) {
+		log::trace("line {}", i);
+	}
+	log::debug("line {}", 3);
+
+	std::string const result {decode()};
+
+	auto const first {result.find("Trace: line 0\n")};
+	auto const second {result.find("Trace: line 1\n")};
+	auto const third {result.find("Trace: line 2\n")};
+	auto const fourth {result.find("Debug: line 3\n")};
+
+	ASSERT_NE(std::string::npos, fourth);
+	ASSERT_LT(first, second);
+	ASSERT_LT(second, third);
+	ASSERT_LT(third, fourth);
+}
+
+TEST_F(LogBinary, level_filtered)
+{
+	log::set_level(log::Level::Debug);
+	log::trace("filtered");
+	log::debug("kept");
+
+	std::string const result {decode()};
+	ASSERT_EQ(std::string::npos, result.find("filtered"));
+	ASSERT_NE(std::string::npos, result.find("Debug: kept\n"));
+}
+
+TEST_F(LogBinary, fallback_to_text)
+{
+	::testing::internal::CaptureStderr();
+	log::trace("{}", NotEncodable {});
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_NE(std::string::npos, result.find("Trace: not-encodable\n"));
+}
+
+TEST_F(LogBinary, mutable_format_buffer)
+{
+	char format[32] {};
+
+	::testing::internal::CaptureStderr();
+
+	std::snprintf(format, sizeof(format), "first {}");
+	log::trace(format, 1);
+	std::snprintf(format, sizeof(format), "second {}");
+	log::trace(format, 2);
+
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_NE(std::string::npos, result.find("Trace: first 1\n"));
+	ASSERT_NE(std::string::npos, result.find("Trace: second 2\n"));
+}
+
+TEST_F(LogBinary, const_arrays_at_same_address)
+{
+	trace_first(1);
+	trace_other(2);
+	trace_first(3);
+
+	std::string const result {decode()};
+	ASSERT_NE(std::string::npos, result.find("Trace: first 1\n"));
+	ASSERT_NE(std::string::npos, result.find("Trace: other 2\n"));
+	ASSERT_NE(std::string::npos, result.find("Trace: first 3\n"));
+}
+
+TEST_F(LogBinary, info_not_deferred)
+{
+	::testing::internal::CaptureStderr();
+	log::info("message");
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_NE(std::string::npos, result.find("Info: message\n"));
+}
+
+TEST_F(LogBinary, reopen_truncates)
+{
+	log::trace("first {}", 1);
+	ASSERT_TRUE(log::binary::open(_path.string().c_str()));
+	log::trace("first {}", 2);
+
+	std::string const result {decode()};
+	ASSERT_EQ(std::string::npos, result.find("first 1"));
+	ASSERT_NE(std::string::npos, result.find("Trace: first 2\n"));
+}
+
+TEST_F(LogBinary, threads)
+{
+	int constexpr thread_count {4};
+	int constexpr per_thread {1000};
+
+	std::vector<std::thread> threads;
+
+	for (int t {0}; t < thread_count; ++t) {
+		threads.emplace_back([t] {
+			for (int i {0}; i < per_thread; ++i) {
+				log::trace("thread {} line {}", t, i);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	std::string const result {decode()};
+
+	std::size_t lines {0};
+	for (auto pos {result.find('\n')}; pos != std::string::npos; pos = result.find('\n', pos + 1)) {
+		++lines;
+	}
+
+	ASSERT_EQ(std::size_t {thread_count * per_thread}, lines);
+	ASSERT_NE(std::string::npos, result.find("Trace: thread 3 line 999\n"));
+}
+
+TEST(LogBinaryDecode, invalid_input)
+{
+	std::FILE* in {std::tmpfile()};
+	std::fputs("not a binary log", in);
+	std::rewind(in);
+
+	ASSERT_FALSE(log::binary::decode(in, stdout));
+
+	std::fclose(in);
+}
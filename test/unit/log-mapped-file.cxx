@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#define ENABLE_LOGGING 1
+#include <log-mapped-file.hxx>
+#undef ENABLE_LOGGING
+
+using namespace project;
+
+namespace {
+auto read_file(std::filesystem::path const& path) -> std::string
+{
+	std::ifstream file {path, std::ios::binary};
+	return {std::istreambuf_iterator<char> {file}, std::istreambuf_iterator<char> {}};
+}
+}  // namespace
+
+class LogMappedFile : public ::testing::Test
+{
+protected:
+	void TearDown() override
+	{
+		for (auto const* suffix : {"", ".1", ".2", ".3"}) {
+			auto path {_path};
+			path += suffix;
+			std::filesystem::remove(path);
+		}
+	}
+
+	auto rotated(int index) const -> std::filesystem::path
+	{
+		auto path {_path};
+		path += "." + std::to_string(index);
+		return path;
+	}
+
+	std::filesystem::path _path {std::filesystem::temp_directory_path() / "unit-project-log-mapped-file.log"};
+};
+
+TEST_F(LogMappedFile, write)
+{
+	{
+		log::MappedFileSink sink {_path, 1024};
+		ASSERT_TRUE(sink.is_open());
+		sink.write(log::Level::Info, "Info: first\n");
+		sink.write(log::Level::Info, "Info: second\n");
+	}
+
+	// Truncated to the written length on close
+	ASSERT_EQ("Info: first\nInfo: second\n", read_file(_path));
+}
+
+TEST_F(LogMappedFile, rotate)
+{
+	{
+		log::MappedFileSink sink {_path, 8, 2};
+		sink.write(log::Level::Info, "aaaa\n");
+		sink.write(log::Level::Info, "bbbb\n");
+		sink.write(log::Level::Info, "cccc\n");
+	}
+
+	ASSERT_EQ("cccc\n", read_file(_path));
+	ASSERT_EQ("bbbb\n", read_file(rotated(1)));
+	ASSERT_EQ("aaaa\n", read_file(rotated(2)));
+}
+
+TEST_F(LogMappedFile, rotate_keeps_max_files)
+{
+	{
+		log::MappedFileSink sink {_path, 8, 1};
+		sink.write(log::Level::Info, "aaaa\n");
+		sink.write(log::Level::Info, "bbbb\n");
+		sink.write(log::Level::Info, "cccc\n");
+	}
+
+	ASSERT_EQ("cccc\n", read_file(_path));
+	ASSERT_EQ("bbbb\n", read_file(rotated(1)));
+	ASSERT_FALSE(std::filesystem::exists(rotated(2)));
+}
+
+TEST_F(LogMappedFile, no_rotated_files)
+{
+	{
+		log::MappedFileSink sink {_path, 8, 0};
+		sink.write(log::Level::Info, "aaaa\n");
+		sink.write(log::Level::Info, "bbbb\n");
+	}
+
+	ASSERT_EQ("bbbb\n", read_file(_path));
+	ASSERT_FALSE(std::filesystem::exists(rotated(1)));
+}
+
+TEST_F(LogMappedFile, reopen_rotates_existing)
+{
+	{
+		log::MappedFileSink sink {_path, 1024, 2};
+		sink.write(log::Level::Info, "first run\n");
+	}
+	{
+		log::MappedFileSink sink {_path, 1024, 2};
+		sink.write(log::Level::Info, "second run\n");
+	}
+
+	ASSERT_EQ("second run\n", read_file(_path));
+	ASSERT_EQ("first run\n", read_file(rotated(1)));
+}
+
+TEST_F(LogMappedFile, reopen_empty_not_rotated)
+{
+	{
+		log::MappedFileSink sink {_path, 1024, 2};
+	}
+	{
+		log::MappedFileSink sink {_path, 1024, 2};
+		sink.write(log::Level::Info, "line\n");
+	}
+
+	ASSERT_EQ("line\n", read_file(_path));
+	ASSERT_FALSE(std::filesystem::exists(rotated(1)));
+}
+
+TEST_F(LogMappedFile, truncate_long_line)
+{
+	{
+		log::MappedFileSink sink {_path, 4, 0};
+		sink.write(log::Level::Info, "abcdefgh\n");
+	}
+
+	ASSERT_EQ("abcd", read_file(_path));
+}
+
+TEST_F(LogMappedFile, invalid_path)
+{
+	log::MappedFileSink sink {"/nonexistent-directory/log.txt", 1024};
+	ASSERT_FALSE(sink.is_open());
+	sink.write(log::Level::Info, "ignored\n");
+}
+
+TEST_F(LogMappedFile, as_sink)
+{
+	log::set_target(nullptr);
+	log::set_level(log::Level::Info);
+	log::add_sink(std::make_shared<log::MappedFileSink>(_path, 1024));
+
+	log::print(log::Level::Info, "{}", "message");
+
+	log::clear_sinks();  // Releases & closes the sink
+	log::set_target(stderr);
+	log::set_level(log::Level::None);
+
+	ASSERT_EQ("Info: message\n", read_file(_path));
+}
@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #define ENABLE_LOGGING 1
 #include <log.hxx>
 #undef ENABLE_LOGGING
@@ -324,3 +331,267 @@ TEST_F(Log, print_enabled_levels_stdout_none)
 	std::string const result = ::testing::internal::GetCapturedStdout();
 	ASSERT_TRUE(result.find("Logging: None\n") != std::string::npos);
 }
+
+TEST_F(Log, is_compiled)
+{
+	EXPECT_EQ(log::Level::Trace, log::MinLevel);  // Default PROJECT_LOG_MIN_LEVEL
+	EXPECT_TRUE(log::is_compiled(log::Level::Error));
+	EXPECT_TRUE(log::is_compiled(log::Level::Trace));
+	EXPECT_FALSE(log::is_compiled(log::Level::None));
+}
+
+TEST_F(Log, is_enabled)
+{
+	log::set_level(log::Level::Info);
+	EXPECT_TRUE(log::is_enabled(log::Level::Error));
+	EXPECT_TRUE(log::is_enabled(log::Level::Info));
+	EXPECT_FALSE(log::is_enabled(log::Level::Debug));
+	EXPECT_FALSE(log::is_enabled(log::Level::None));
+}
+
+TEST_F(Log, macro)
+{
+	log::set_level(log::Level::Info);
+	::testing::internal::CaptureStderr();
+	PROJECT_LOG(Info, "{} {}", "message", 1);
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_TRUE(result.find("Info: message 1\n") != std::string::npos);
+}
+
+TEST_F(Log, macro_skips_arguments)
+{
+	int evaluated {0};
+	auto const argument = [&evaluated] { return ++evaluated; };
+
+	log::set_level(log::Level::Info);
+	::testing::internal::CaptureStderr();
+	PROJECT_LOG(Debug, "{}", argument());
+	PROJECT_LOG(Info, "{}", argument());
+	std::string const result {::testing::internal::GetCapturedStderr()};
+
+	ASSERT_EQ(1, evaluated);
+	ASSERT_TRUE(result.find("Info: 1\n") != std::string::npos);
+}
+
+TEST_F(Log, every_n)
+{
+	log::EveryN site;
+	EXPECT_TRUE(site.should_log(3));
+	EXPECT_FALSE(site.should_log(3));
+	EXPECT_FALSE(site.should_log(3));
+	EXPECT_TRUE(site.should_log(3));
+}
+
+TEST_F(Log, every_n_zero)
+{
+	log::EveryN site;
+	EXPECT_TRUE(site.should_log(0));
+	EXPECT_TRUE(site.should_log(0));
+}
+
+TEST_F(Log, print_every_n)
+{
+	log::set_level(log::Level::Warning);
+	log::EveryN site;
+	::testing::internal::CaptureStderr();
+	for (int i {0}; i < 5; ++i) {
+		log::print_every_n(site, 2, log::Level::Warning, "line {}", i);
+	}
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_EQ("Warning: line 0\nWarning: line 2\nWarning: line 4\n", result);
+}
+
+TEST_F(Log, macro_every_n)
+{
+	log::set_level(log::Level::Warning);
+	::testing::internal::CaptureStderr();
+	for (int i {0}; i < 5; ++i) {
+		PROJECT_LOG_EVERY_N(Warning, 2, "line {}", i);
+	}
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_EQ("Warning: line 0\nWarning: line 2\nWarning: line 4\n", result);
+}
+
+TEST_F(Log, at_most)
+{
+	log::AtMost site;
+	EXPECT_TRUE(site.should_log(1.0));
+	EXPECT_FALSE(site.should_log(1.0));  // Within one second of the first call
+	EXPECT_FALSE(site.should_log(0.0));
+}
+
+TEST_F(Log, at_most_tiny_rate)
+{
+	log::AtMost site;
+	EXPECT_TRUE(site.should_log(1e-300));  // Interval clamped rather than overflowing
+	EXPECT_FALSE(site.should_log(1e-300));
+	EXPECT_FALSE(site.should_log(1e-12));
+}
+
+TEST_F(Log, print_at_most)
+{
+	log::set_level(log::Level::Info);
+	log::AtMost site;
+	::testing::internal::CaptureStderr();
+	for (int i {0}; i < 5; ++i) {
+		log::print_at_most(site, 1.0, log::Level::Info, "line {}", i);
+	}
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_EQ("Info: line 0\n", result);
+}
+
+TEST_F(Log, macro_at_most)
+{
+	log::set_level(log::Level::Info);
+	::testing::internal::CaptureStderr();
+	for (int i {0}; i < 5; ++i) {
+		PROJECT_LOG_AT_MOST(Info, 1.0, "line {}", i);
+	}
+	std::string const result {::testing::internal::GetCapturedStderr()};
+	ASSERT_EQ("Info: line 0\n", result);
+}
+
+namespace {
+struct RecordingSink : log::Sink
+{
+	std::vector<std::string> lines;
+
+	void write(log::Level, std::string_view line) override
+	{
+		lines.emplace_back(line);
+	}
+};
+}  // namespace
+
+class LogSink : public Log
+{
+protected:
+	void TearDown() override
+	{
+		log::clear_sinks();
+	}
+};
+
+TEST_F(LogSink, fan_out)
+{
+	auto const first {std::make_shared<RecordingSink>()};
+	auto const second {std::make_shared<RecordingSink>()};
+
+	log::add_sink(first);
+	log::add_sink(second);
+	log::set_target(nullptr);
+	log::set_level(log::Level::Info);
+
+	log::info("{}", "message");
+
+	ASSERT_EQ(std::vector<std::string> {"Info: message\n"}, first->lines);
+	ASSERT_EQ(std::vector<std::string> {"Info: message\n"}, second->lines);
+}
+
+TEST_F(LogSink, sink_level)
+{
+	auto const verbose {std::make_shared<RecordingSink>()};
+	auto const quiet {std::make_shared<RecordingSink>()};
+	quiet->set_level(log::Level::Warning);
+
+	log::add_sink(verbose);
+	log::add_sink(quiet);
+	log::set_target(nullptr);
+	log::set_level(log::Level::Trace);
+
+	log::error("error");
+	log::info("info");
+
+	ASSERT_EQ(2, verbose->lines.size());
+	ASSERT_EQ(std::vector<std::string> {"Error: error\n"}, quiet->lines);
+}
+
+TEST_F(LogSink, target_and_sink)
+{
+	auto const sink {std::make_shared<RecordingSink>()};
+	log::add_sink(sink);
+	log::set_level(log::Level::Error);
+
+	::testing::internal::CaptureStderr();
+	log::error("message");
+	std::string const result {::testing::internal::GetCapturedStderr()};
+
+	ASSERT_TRUE(result.find("Error: message\n") != std::string::npos);
+	ASSERT_EQ(std::vector<std::string> {"Error: message\n"}, sink->lines);
+}
+
+TEST_F(LogSink, remove_sink)
+{
+	auto const sink {std::make_shared<RecordingSink>()};
+	log::add_sink(sink);
+	log::remove_sink(sink);
+	log::set_target(nullptr);
+	log::set_level(log::Level::Error);
+
+	log::error("message");
+
+	ASSERT_TRUE(sink->lines.empty());
+}
+
+TEST_F(LogSink, file_sink)
+{
+	std::FILE* file {std::tmpfile()};
+	log::add_sink(std::make_shared<log::FileSink>(file));
+	log::set_target(nullptr);
+	log::set_level(log::Level::Error);
+
+	log::error("message");
+	log::flush();
+
+	std::string result(static_cast<std::size_t>(std::ftell(file)), '\0');
+	std::rewind(file);
+	result.resize(std::fread(result.data(), 1, result.size(), file));
+	std::fclose(file);
+
+	ASSERT_EQ("Error: message\n", result);
+}
+
+TEST_F(LogSink, threads)
+{
+	auto const sink {std::make_shared<RecordingSink>()};
+	std::mutex mutex;
+
+	struct LockedSink : log::Sink
+	{
+		RecordingSink& inner;
+		std::mutex& mutex;
+		LockedSink(RecordingSink& inner, std::mutex& mutex)
+		    : inner {inner}
+		    , mutex {mutex}
+		{}
+		void write(log::Level level, std::string_view line) override
+		{
+			std::lock_guard const lock {mutex};
+			inner.write(level, line);
+		}
+	};
+
+	log::set_target(nullptr);
+	log::set_level(log::Level::Info);
+
+	std::vector<std::thread> threads;
+
+	for (int t {0}; t < 4; ++t) {
+		threads.emplace_back([&, t] {
+			for (int i {0}; i < 100; ++i) {
+				if (t == 0 && i == 50) {
+					log::add_sink(std::make_shared<LockedSink>(*sink, mutex));
+				}
+				log::info("{} {}", t, i);
+				log::set_level(log::Level::Info);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	ASSERT_FALSE(sink->lines.empty());
+	ASSERT_LE(sink->lines.size(), 400);
+}
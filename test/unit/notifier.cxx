@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <notifier.hxx>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace project;
+using namespace std::chrono_literals;
+
+using Clock = detail::Notifier::Clock;
+
+TEST(Notifier, wait_times_out)
+{
+	detail::Notifier notifier;
+
+	auto const start {Clock::now()};
+	notifier.wait_until(start + 10ms);
+
+	ASSERT_GE(Clock::now() - start, 10ms);
+}
+
+TEST(Notifier, notify_before_wait)
+{
+	detail::Notifier notifier;
+
+	notifier.notify();
+	notifier.notify();
+
+	auto const start {Clock::now()};
+	notifier.wait_until(Clock::time_point::max());
+
+	ASSERT_LT(Clock::now() - start, 5s);
+
+	// Both notifications were consumed by the one wait
+	notifier.wait_until(Clock::now() + 10ms);
+	ASSERT_GE(Clock::now() - start, 10ms);
+}
+
+TEST(Notifier, notify_from_other_thread)
+{
+	detail::Notifier notifier;
+
+	std::thread notifying {[&] {
+		std::this_thread::sleep_for(10ms);
+		notifier.notify();
+	}};
+
+	notifier.wait_until(Clock::time_point::max());
+	notifying.join();
+}
+
+#ifdef __linux__
+TEST(Notifier, fallback_without_descriptors)
+{
+	using namespace std::chrono_literals;
+
+	rlimit const original {[] {
+		rlimit limit {};
+		getrlimit(RLIMIT_NOFILE, &limit);
+		return limit;
+	}()};
+
+	// Exhaust descriptors under a low limit, so that eventfd() fails
+	rlimit lowered {original};
+	lowered.rlim_cur = 64;
+	ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &lowered));
+
+	std::vector<int> taken;
+	for (int fd {dup(0)}; fd >= 0; fd = dup(0)) {
+		taken.push_back(fd);
+	}
+
+	{
+		detail::Notifier notifier;
+		EXPECT_EQ(-1, notifier.handle());
+
+		std::thread notifying {[&] {
+			std::this_thread::sleep_for(10ms);
+			notifier.notify();
+		}};
+
+		// Still wakes rather than sleeping forever
+		notifier.wait_until(Clock::time_point::max());
+		notifying.join();
+	}
+
+	for (auto const fd : taken) {
+		close(fd);
+	}
+
+	setrlimit(RLIMIT_NOFILE, &original);
+}
+#endif
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <snapshot.hxx>
+
+using namespace project;
+
+TEST(SnapshotCell, starts_empty)
+{
+	detail::SnapshotCell<std::vector<int>> cell;
+
+	ASSERT_TRUE(cell.read()->empty());
+}
+
+TEST(SnapshotCell, update)
+{
+	detail::SnapshotCell<std::vector<int>> cell;
+
+	cell.update([](std::vector<int>& value) { value.push_back(1); });
+	auto const size {cell.update([](std::vector<int>& value) {
+		value.push_back(2);
+		return value.size();
+	})};
+
+	ASSERT_EQ(2u, size);
+	ASSERT_EQ((std::vector<int> {1, 2}), *cell.read());
+}
+
+TEST(SnapshotCell, reader_keeps_its_version)
+{
+	detail::SnapshotCell<std::vector<int>> cell;
+
+	cell.update([](std::vector<int>& value) { value.push_back(1); });
+
+	auto const reader {cell.read()};
+
+	cell.update([](std::vector<int>& value) { value.clear(); });
+
+	ASSERT_EQ((std::vector<int> {1}), *reader);
+	ASSERT_TRUE(cell.read()->empty());
+}
+
+TEST(SnapshotCell, concurrent_readers_and_writer)
+{
+	detail::SnapshotCell<std::vector<int>> cell;
+
+	std::atomic<bool> done {false};
+	std::vector<std::thread> readers;
+
+	for (int i {0}; i < 4; ++i) {
+		readers.emplace_back([&] {
+			while (!done.load()) {
+				auto const reader {cell.read()};
+				int expected {0};
+				// Every version is a complete prefix 0..n-1
+				for (auto const value : *reader) {
+					ASSERT_EQ(expected++, value);
+				}
+			}
+		});
+	}
+
+	for (int i {0}; i < 1000; ++i) {
+		cell.update([i](std::vector<int>& value) { value.push_back(i); });
+	}
+
+	done = true;
+
+	for (auto& reader : readers) {
+		reader.join();
+	}
+
+	ASSERT_EQ(1000u, cell.read()->size());
+}
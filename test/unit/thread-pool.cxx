@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <thread-pool.hxx>
+
+using namespace project;
+
+TEST(ThreadPool, run_all)
+{
+	detail::ThreadPool pool {3};
+
+	std::vector<int> ran(10);
+
+	pool.run_all(ran.size(), [&ran](std::size_t const index) { ran[index] += 1; });
+
+	ASSERT_EQ(std::vector<int>(10, 1), ran);
+}
+
+TEST(ThreadPool, run_none)
+{
+	detail::ThreadPool pool {1};
+
+	pool.run_all(0, [](std::size_t) { FAIL(); });
+}
+
+TEST(ThreadPool, without_workers)
+{
+	detail::ThreadPool pool {0};
+
+	int ran {0};
+	pool.run_all(3, [&ran](std::size_t) { ++ran; });
+
+	ASSERT_EQ(3, ran);
+}
+
+TEST(ThreadPool, rethrows_after_all_finish)
+{
+	detail::ThreadPool pool {2};
+
+	std::atomic<int> ran {0};
+
+	auto const task = [&ran](std::size_t const index) {
+		++ran;
+		if (index == 1) {
+			throw std::runtime_error {"task"};
+		}
+	};
+
+	ASSERT_THROW(pool.run_all(5, task), std::runtime_error);
+	ASSERT_EQ(5, ran);
+
+	// Still usable afterwards
+	pool.run_all(5, [&ran](std::size_t) { ++ran; });
+	ASSERT_EQ(10, ran);
+}
@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <timer-wheel.hxx>
+
+using namespace project;
+using namespace std::chrono_literals;
+
+namespace {
+struct RecordAction : detail::TimerAction
+{
+	std::vector<int>& fired;
+	int id;
+
+	RecordAction(std::vector<int>& fired, int id)
+	    : fired {fired}
+	    , id {id}
+	{}
+
+	void fire() override
+	{
+		fired.push_back(id);
+	}
+};
+}  // namespace
+
+class TimerWheel : public ::testing::Test
+{
+protected:
+	auto schedule(std::chrono::milliseconds delay, int id) -> TimerHandle
+	{
+		return _wheel.schedule(_epoch + delay, std::make_unique<RecordAction>(_fired, id));
+	}
+
+	void advance(std::chrono::milliseconds to)
+	{
+		_wheel.advance(_epoch + to);
+	}
+
+	detail::TimerWheel::Clock::time_point const _epoch {};
+	detail::TimerWheel _wheel {_epoch};
+	std::vector<int> _fired;
+};
+
+TEST_F(TimerWheel, fire_at_deadline)
+{
+	schedule(10ms, 1);
+
+	advance(9ms);
+	ASSERT_TRUE(_fired.empty());
+
+	advance(10ms);
+	ASSERT_EQ(std::vector<int> {1}, _fired);
+	ASSERT_EQ(0, _wheel.size());
+}
+
+TEST_F(TimerWheel, past_deadline_fires_on_next_advance)
+{
+	advance(100ms);
+	schedule(50ms, 1);
+
+	ASSERT_TRUE(_fired.empty());
+	advance(100ms);
+	ASSERT_EQ(std::vector<int> {1}, _fired);
+}
+
+TEST_F(TimerWheel, resolution)
+{
+	_wheel.schedule(_epoch + 1500us, std::make_unique<RecordAction>(_fired, 1));
+
+	// Never before the deadline, at most one tick after it
+	_wheel.advance(_epoch + 1999us);
+	ASSERT_TRUE(_fired.empty());
+
+	_wheel.advance(_epoch + 2000us);
+	ASSERT_EQ(std::vector<int> {1}, _fired);
+}
+
+TEST_F(TimerWheel, order_across_levels)
+{
+	// Deadlines in each level of the wheel
+	schedule(5s, 4);
+	schedule(70ms, 2);
+	schedule(3ms, 1);
+	schedule(300s, 5);
+	schedule(1s, 3);
+
+	advance(2h);
+
+	ASSERT_EQ((std::vector<int> {1, 2, 3, 4, 5}), _fired);
+}
+
+TEST_F(TimerWheel, cascade_exact)
+{
+	// Each deadline must fire exactly on time, not just in order
+	for (auto const delay : {63ms, 64ms, 65ms, 4095ms, 4096ms, 4097ms, 262144ms, 262145ms}) {
+		detail::TimerWheel wheel {_epoch};
+		std::vector<int> fired;
+
+		wheel.schedule(_epoch + delay, std::make_unique<RecordAction>(fired, 1));
+
+		wheel.advance(_epoch + delay - 1ms);
+		ASSERT_TRUE(fired.empty()) << delay.count();
+
+		wheel.advance(_epoch + delay);
+		ASSERT_EQ(1, fired.size()) << delay.count();
+	}
+}
+
+TEST_F(TimerWheel, beyond_range)
+{
+	schedule(10h, 1);
+
+	advance(9h);
+	ASSERT_TRUE(_fired.empty());
+
+	advance(10h);
+	ASSERT_EQ(std::vector<int> {1}, _fired);
+}
+
+TEST_F(TimerWheel, cancel)
+{
+	auto const handle {schedule(10ms, 1)};
+	schedule(10ms, 2);
+
+	ASSERT_TRUE(_wheel.cancel(handle));
+	ASSERT_FALSE(_wheel.cancel(handle));
+	ASSERT_EQ(1, _wheel.size());
+
+	advance(10ms);
+	ASSERT_EQ(std::vector<int> {2}, _fired);
+}
+
+TEST_F(TimerWheel, cancel_after_fire)
+{
+	auto const handle {schedule(10ms, 1)};
+	advance(10ms);
+
+	// The node is reused by the next timer; the old handle must not cancel it
+	schedule(20ms, 2);
+
+	ASSERT_FALSE(_wheel.cancel(handle));
+	advance(20ms);
+	ASSERT_EQ((std::vector<int> {1, 2}), _fired);
+}
+
+TEST_F(TimerWheel, cancel_default_handle)
+{
+	ASSERT_FALSE(_wheel.cancel(TimerHandle {}));
+}
+
+TEST_F(TimerWheel, many)
+{
+	int constexpr count {100'000};
+
+	std::vector<TimerHandle> handles;
+
+	for (int i {0}; i < count; ++i) {
+		handles.push_back(schedule(std::chrono::milliseconds {i % 5000}, i));
+	}
+
+	for (int i {0}; i < count; i += 2) {
+		ASSERT_TRUE(_wheel.cancel(handles[i]));
+	}
+
+	advance(5s);
+
+	ASSERT_EQ(count / 2, _fired.size());
+	ASSERT_EQ(0, _wheel.size());
+}
+
+TEST_F(TimerWheel, next_expiry_empty)
+{
+	ASSERT_EQ(detail::TimerWheel::Clock::time_point::max(), _wheel.next_expiry());
+}
+
+TEST_F(TimerWheel, next_expiry_near)
+{
+	schedule(30ms, 1);
+	schedule(10ms, 2);
+
+	ASSERT_EQ(_epoch + 10ms, _wheel.next_expiry());
+
+	advance(10ms);
+	ASSERT_EQ(_epoch + 30ms, _wheel.next_expiry());
+}
+
+TEST_F(TimerWheel, next_expiry_due)
+{
+	advance(5ms);
+	schedule(1ms, 1);
+
+	ASSERT_EQ(_epoch + 5ms, _wheel.next_expiry());
+}
+
+TEST_F(TimerWheel, next_expiry_never_late)
+{
+	std::vector<std::chrono::milliseconds> deadlines;
+
+	// Deterministic spread across every level, including beyond the wheel's range
+	std::uint64_t state {12345};
+	for (int i {0}; i < 200; ++i) {
+		state = state * 6364136223846793005u + 1442695040888963407u;
+		auto const delay {std::chrono::milliseconds {(state >> 33) % (i % 4 == 0 ? 20'000'000 : 300'000)}};
+		deadlines.push_back(delay);
+		schedule(delay, i);
+	}
+
+	// Advancing to each reported expiry in turn must fire every timer at its deadline
+	while (_wheel.size() > 0) {
+		auto const next {_wheel.next_expiry()};
+
+		auto const fired {_fired.size()};
+		_wheel.advance(next);
+
+		for (auto i {fired}; i < _fired.size(); ++i) {
+			ASSERT_EQ(_epoch + deadlines[static_cast<std::size_t>(_fired[i])], next);
+		}
+	}
+
+	ASSERT_EQ(deadlines.size(), _fired.size());
+}
+
+TEST_F(TimerWheel, memory_usage)
+{
+	ASSERT_EQ(0u, _wheel.memory_usage());
+
+	schedule(1ms, 1);
+
+	auto const used {_wheel.memory_usage()};
+	ASSERT_GT(used, 0u);
+
+	// The pool is reused rather than freed
+	advance(1ms);
+	ASSERT_EQ(used, _wheel.memory_usage());
+}
+
+TEST_F(TimerWheel, shrink_to_fit)
+{
+	std::vector<TimerHandle> burst;
+
+	for (int id {0}; id < 100; ++id) {
+		burst.push_back(schedule(1ms, id));
+	}
+
+	auto const kept {schedule(10ms, 100)};
+	auto const peak {_wheel.memory_usage()};
+
+	advance(1ms);
+	_wheel.shrink_to_fit();
+
+	// The pending timer was scheduled last, so nothing can be freed yet
+	ASSERT_EQ(1, _wheel.size());
+	ASSERT_LE(_wheel.memory_usage(), peak);
+
+	_wheel.cancel(kept);
+	_wheel.shrink_to_fit();
+	ASSERT_EQ(0u, _wheel.memory_usage());
+
+	_fired.clear();
+	schedule(5ms, 200);
+
+	// Timers reusing freed slots do not answer to their handles
+	for (auto const& handle : burst) {
+		ASSERT_FALSE(_wheel.cancel(handle));
+	}
+	ASSERT_FALSE(_wheel.cancel(kept));
+
+	advance(10ms);
+	ASSERT_EQ(std::vector<int> {200}, _fired);
+}
+
+TEST_F(TimerWheel, shrink_to_fit_keeps_pending)
+{
+	schedule(5ms, 1);
+	auto const freed {schedule(5ms, 2)};
+	auto const pending {schedule(5ms, 3)};
+
+	_wheel.cancel(freed);
+	_wheel.shrink_to_fit();
+
+	// Freed slots before a pending timer are reused
+	auto const reused {schedule(5ms, 4)};
+	ASSERT_FALSE(_wheel.cancel(freed));
+	ASSERT_EQ(3, _wheel.size());
+
+	advance(5ms);
+	std::sort(_fired.begin(), _fired.end());
+	ASSERT_EQ((std::vector<int> {1, 3, 4}), _fired);
+	ASSERT_FALSE(_wheel.cancel(pending));
+	ASSERT_FALSE(_wheel.cancel(reused));
+}
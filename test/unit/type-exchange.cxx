@@ -1,7 +1,22 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
 #include <type-exchange.hxx>
 
+#ifdef __linux__
+#include <poll.h>
+#endif
+
 using namespace project;
 
 namespace {
@@ -29,6 +44,16 @@ struct NonMoveable
 	NonMoveable() = default;
 };
 
+template <int N>
+struct Tag
+{};
+
+template <int... N>
+void subscribe_tags(TypeExchange& exchange, std::integer_sequence<int, N...>)
+{
+	(exchange.subscribe<Tag<N>>([](Tag<N> const&) {}), ...);
+}
+
 struct Receiver
 {
 	int _value {};
@@ -234,3 +259,982 @@ TEST(TypeExchange, process_multiple)
 	ASSERT_EQ(6, receiver._value);
 	ASSERT_EQ("Hello, world!\nGoodbye!", receiver._str);
 }
+
+TEST(TypeExchange, conflate)
+{
+	TypeExchange exchange;
+
+	std::vector<int> received;
+
+	exchange.conflate<int>();
+	exchange.subscribe<int>([&received](int const& message) { received.push_back(message); });
+
+	exchange.publish(1);
+	exchange.publish(2);
+	exchange.publish(3);
+
+	exchange.process_messages();
+
+	ASSERT_EQ(std::vector<int> {3}, received);
+
+	// --- Slot is emptied by processing
+	exchange.process_messages();
+
+	ASSERT_EQ(std::vector<int> {3}, received);
+
+	exchange.publish(4);
+	exchange.process_messages();
+
+	ASSERT_EQ((std::vector<int> {3, 4}), received);
+}
+
+TEST(TypeExchange, conflate_queued)
+{
+	TypeExchange exchange;
+
+	int value {0};
+	int calls {0};
+
+	exchange.subscribe<int>([&](int const& message) {
+		value = message;
+		++calls;
+	});
+
+	exchange.publish(1);
+	exchange.publish(2);
+
+	exchange.conflate<int>();  // Conflates messages queued before this call
+
+	exchange.process_messages();
+
+	ASSERT_EQ(2, value);
+	ASSERT_EQ(1, calls);
+}
+
+TEST(TypeExchange, conflate_keyed)
+{
+	struct Position
+	{
+		std::size_t id;
+		int x;
+	};
+
+	TypeExchange exchange;
+
+	std::vector<std::pair<std::size_t, int>> received;
+
+	exchange.conflate<Position>([](Position const& message) { return message.id; });
+	exchange.subscribe<Position>([&received](Position const& message) { received.emplace_back(message.id, message.x); });
+
+	exchange.publish(Position {7, 1});
+	exchange.publish(Position {3, 1});
+	exchange.publish(Position {7, 2});
+	exchange.publish(Position {3, 2});
+	exchange.publish(Position {7, 3});
+
+	exchange.process_messages();
+
+	// In order of each key's first publish
+	ASSERT_EQ((std::vector<std::pair<std::size_t, int>> {{7, 3}, {3, 2}}), received);
+}
+
+TEST(TypeExchange, conflate_other_types_unaffected)
+{
+	TypeExchange exchange;
+
+	int int_value {0};
+	std::string string_value;
+
+	exchange.conflate<int>();
+	exchange.subscribe<int>([&int_value](int const& message) { int_value += message; });
+	exchange.subscribe<std::string>([&string_value](std::string const& message) { string_value += message; });
+
+	exchange.publish(1);
+	exchange.publish(2);
+	exchange.publish(std::string {"Hello, "});
+	exchange.publish(std::string {"world!"});
+
+	exchange.process_messages();
+
+	ASSERT_EQ(2, int_value);
+	ASSERT_EQ("Hello, world!", string_value);
+}
+
+TEST(TypeExchange, conflate_non_moveable)
+{
+	TypeExchange exchange;
+
+	int calls {0};
+
+	exchange.conflate<NonMoveable>();
+	exchange.subscribe<NonMoveable>([&calls](NonMoveable const&) { ++calls; });
+
+	NonMoveable nm;
+
+	exchange.publish(NonMoveable(nm));
+	exchange.publish(NonMoveable(nm));
+
+	exchange.process_messages();
+
+	ASSERT_EQ(1, calls);
+}
+
+TEST(TypeExchange, publish_at_past)
+{
+	TypeExchange exchange;
+
+	int value {0};
+
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+
+	exchange.publish_at(TypeExchange::Clock::now(), 1);
+
+	ASSERT_EQ(0, value);
+
+	exchange.process_messages();
+
+	ASSERT_EQ(1, value);
+}
+
+TEST(TypeExchange, publish_after)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	int value {0};
+
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+
+	exchange.publish_after(10ms, 1);
+
+	exchange.process_messages();
+
+	ASSERT_EQ(0, value);
+
+	std::this_thread::sleep_for(20ms);
+
+	exchange.process_messages();
+
+	ASSERT_EQ(1, value);
+}
+
+TEST(TypeExchange, publish_after_never_early)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	std::chrono::steady_clock::time_point delivered {};
+	exchange.subscribe<int>([&delivered](int const&) { delivered = std::chrono::steady_clock::now(); });
+
+	for (int i {0}; i < 20; ++i) {
+		delivered = {};
+
+		auto const start {std::chrono::steady_clock::now()};
+		exchange.publish_after(2ms, int {i});
+
+		while (delivered == std::chrono::steady_clock::time_point {}) {
+			exchange.process_messages();
+		}
+
+		ASSERT_GE(delivered - start, 2ms);
+	}
+}
+
+TEST(TypeExchange, publish_at_past_cancels_nothing)
+{
+	TypeExchange exchange;
+
+	auto const handle {exchange.publish_at(TypeExchange::Clock::now() - std::chrono::seconds {1}, 1)};
+
+	ASSERT_FALSE(exchange.cancel(handle));
+}
+
+TEST(TypeExchange, publish_after_cancel)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	int value {0};
+
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+
+	auto const handle {exchange.publish_after(10ms, 1)};
+
+	ASSERT_TRUE(exchange.cancel(handle));
+
+	std::this_thread::sleep_for(20ms);
+	exchange.process_messages();
+
+	ASSERT_EQ(0, value);
+	ASSERT_FALSE(exchange.cancel(handle));
+}
+
+TEST(TypeExchange, publish_after_non_copyable)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	int calls {0};
+
+	exchange.subscribe<NonCopyable>([&calls](NonCopyable const&) { ++calls; });
+
+	exchange.publish_after(0ms, NonCopyable {});
+
+	exchange.process_messages();
+
+	ASSERT_EQ(1, calls);
+}
+
+TEST(TypeExchange, process_messages_defers_cascade)
+{
+	TypeExchange exchange;
+
+	std::string result;
+
+	exchange.subscribe<int>([&exchange](int const& message) { exchange.publish(std::to_string(message)); });
+	exchange.subscribe<std::string>([&result](std::string const& message) { result += message; });
+
+	exchange.publish(1);
+
+	exchange.process_messages();
+
+	ASSERT_EQ("", result);
+
+	exchange.process_messages();
+
+	ASSERT_EQ("1", result);
+}
+
+TEST(TypeExchange, process_until_idle)
+{
+	TypeExchange exchange;
+
+	std::vector<int> received;
+
+	// Each message publishes its successor until 5
+	exchange.subscribe<int>([&](int const& message) {
+		received.push_back(message);
+		if (message < 5) {
+			exchange.publish(message + 1);
+		}
+	});
+
+	exchange.publish(1);
+
+	ASSERT_TRUE(exchange.process_until_idle(10));
+	ASSERT_EQ((std::vector<int> {1, 2, 3, 4, 5}), received);
+}
+
+TEST(TypeExchange, process_until_idle_across_types)
+{
+	TypeExchange exchange;
+
+	std::string result;
+
+	exchange.subscribe<int>([&exchange](int const& message) { exchange.publish(std::to_string(message)); });
+	exchange.subscribe<std::string>([&](std::string const& message) {
+		result += message;
+		if (result.size() < 3) {
+			exchange.publish(static_cast<int>(result.size()) + 1);
+		}
+	});
+
+	exchange.publish(1);
+
+	ASSERT_TRUE(exchange.process_until_idle(10));
+	ASSERT_EQ("123", result);
+}
+
+TEST(TypeExchange, process_until_idle_round_limit)
+{
+	TypeExchange exchange;
+
+	int calls {0};
+
+	// Feedback loop: never idle
+	exchange.subscribe<int>([&](int const& message) {
+		++calls;
+		exchange.publish(message + 1);
+	});
+
+	exchange.publish(1);
+
+	ASSERT_FALSE(exchange.process_until_idle(3));
+	ASSERT_EQ(3, calls);
+
+	// Remaining message is still pending
+	exchange.process_messages();
+	ASSERT_EQ(4, calls);
+}
+
+TEST(TypeExchange, process_until_idle_already_idle)
+{
+	TypeExchange exchange;
+
+	exchange.subscribe<int>([](int const&) {});
+
+	ASSERT_TRUE(exchange.process_until_idle(0));
+	ASSERT_TRUE(exchange.process_until_idle(1));
+}
+
+TEST(TypeExchange, unsubscribe)
+{
+	TypeExchange exchange;
+
+	int first {0};
+	int second {0};
+
+	auto const id {exchange.subscribe<int>([&first](int const&) { ++first; })};
+	exchange.subscribe<int>([&second](int const&) { ++second; });
+
+	exchange.publish(1);
+	exchange.process_messages();
+
+	ASSERT_TRUE(exchange.unsubscribe<int>(id));
+	ASSERT_FALSE(exchange.unsubscribe<int>(id));
+
+	exchange.publish(1);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, first);
+	ASSERT_EQ(2, second);
+}
+
+TEST(TypeExchange, unsubscribe_other_type)
+{
+	TypeExchange exchange;
+
+	auto const id {exchange.subscribe<int>([](int const&) {})};
+
+	ASSERT_FALSE(exchange.unsubscribe<std::string>(id));
+	ASSERT_TRUE(exchange.unsubscribe<int>(id));
+}
+
+TEST(TypeExchange, subscribe_during_dispatch)
+{
+	TypeExchange exchange;
+
+	int added_calls {0};
+
+	exchange.subscribe<int>([&](int const&) {
+		exchange.subscribe<int>([&added_calls](int const&) { ++added_calls; });
+	});
+
+	exchange.publish(1);
+	exchange.publish(2);
+	exchange.process_messages();
+
+	// Not called during the dispatch which added it
+	ASSERT_EQ(0, added_calls);
+
+	exchange.publish(3);
+	exchange.process_messages();
+
+	ASSERT_EQ(2, added_calls);
+}
+
+TEST(TypeExchange, unsubscribe_self_during_dispatch)
+{
+	TypeExchange exchange;
+
+	int calls {0};
+	SubscriptionId id {};
+
+	id = exchange.subscribe<int>([&](int const&) {
+		++calls;
+		exchange.unsubscribe<int>(id);
+	});
+
+	exchange.publish(1);
+	exchange.process_messages();
+
+	exchange.publish(2);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, calls);
+}
+
+TEST(TypeExchange, subscribe_from_other_thread)
+{
+	TypeExchange exchange;
+
+	std::atomic<bool> done {false};
+	std::atomic<int> calls {0};
+
+	// Churn subscriptions while this thread dispatches
+	std::thread churn {[&] {
+		while (!done.load()) {
+			auto const id {exchange.subscribe<int>([&calls](int const&) { ++calls; })};
+			exchange.unsubscribe<int>(id);
+		}
+	}};
+
+	int received {0};
+	exchange.subscribe<int>([&received](int const&) { ++received; });
+
+	for (int i {0}; i < 1000; ++i) {
+		exchange.publish(int {i});
+		exchange.process_messages();
+	}
+
+	done = true;
+	churn.join();
+
+	ASSERT_EQ(1000, received);
+}
+
+TEST(TypeExchange, publish_while_other_thread_adds_types)
+{
+	TypeExchange exchange;
+
+	int received {0};
+	exchange.subscribe<int>([&received](int const&) { ++received; });
+
+	// Each new type updates the lookup table this thread reads without locking
+	std::thread adder {[&exchange] { subscribe_tags(exchange, std::make_integer_sequence<int, 64> {}); }};
+
+	for (int i {0}; i < 1000; ++i) {
+		exchange.publish(int {i});
+		exchange.process_messages();
+	}
+
+	adder.join();
+
+	ASSERT_EQ(1000, received);
+	ASSERT_EQ(65u, exchange.memory_usage().types.size());
+}
+
+TEST(TypeExchange, channel)
+{
+	TypeExchange exchange;
+
+	auto const channel {exchange.channel<int>()};
+
+	int value {0};
+	channel.subscribe([&value](int const& message) { value += message; });
+
+	channel.publish(1);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, value);
+}
+
+TEST(TypeExchange, channel_emplace)
+{
+	TypeExchange exchange;
+
+	auto const channel {exchange.channel<std::string>()};
+
+	std::string result;
+	channel.subscribe([&result](std::string const& message) { result += message; });
+
+	channel.emplace(3, 'a');
+	exchange.process_messages();
+
+	ASSERT_EQ("aaa", result);
+}
+
+TEST(TypeExchange, channel_shares_handler)
+{
+	TypeExchange exchange;
+
+	auto const channel {exchange.channel<int>()};
+
+	std::vector<int> received;
+	auto const id {exchange.subscribe<int>([&received](int const& message) { received.push_back(message); })};
+
+	// Messages of both paths share one queue & keep their order
+	channel.publish(1);
+	exchange.publish(2);
+	channel.publish(3);
+	exchange.process_messages();
+
+	ASSERT_EQ((std::vector<int> {1, 2, 3}), received);
+
+	ASSERT_TRUE(channel.unsubscribe(id));
+}
+
+TEST(TypeExchange, channel_non_copyable)
+{
+	TypeExchange exchange;
+
+	auto const channel {exchange.channel<NonCopyable>()};
+
+	int calls {0};
+	channel.subscribe([&calls](NonCopyable const&) { ++calls; });
+
+	channel.publish(NonCopyable {});
+	channel.emplace();
+	exchange.process_messages();
+
+	ASSERT_EQ(2, calls);
+}
+
+TEST(TypeExchange, wait_timeout)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	// Clear the notification from creating the wakeup mechanism
+	exchange.wait(0ms);
+
+	auto const start {std::chrono::steady_clock::now()};
+	exchange.wait(20ms);
+
+	ASSERT_GE(std::chrono::steady_clock::now() - start, 20ms);
+}
+
+TEST(TypeExchange, wait_returns_on_publish)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+	std::mutex mutex;
+
+	int value {0};
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+
+	exchange.wait(0ms);
+
+	std::thread producer {[&] {
+		std::this_thread::sleep_for(10ms);
+		std::lock_guard const lock {mutex};
+		exchange.publish(1);
+	}};
+
+	exchange.wait(10s);
+
+	{
+		std::lock_guard const lock {mutex};
+		exchange.process_messages();
+	}
+
+	producer.join();
+
+	ASSERT_EQ(1, value);
+}
+
+TEST(TypeExchange, wait_until_timed_message)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	int value {0};
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+
+	exchange.wait(0ms);
+	exchange.publish_after(10ms, 1);
+
+	auto const start {std::chrono::steady_clock::now()};
+
+	while (value == 0) {
+		exchange.wait_and_process(10s);
+	}
+
+	ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(TypeExchange, run_until_stop)
+{
+	TypeExchange exchange;
+	std::mutex mutex;
+
+	std::atomic<int> received {0};
+
+	exchange.subscribe<int>([&](int const&) {
+		if (++received == 100) {
+			exchange.stop();
+		}
+	});
+
+	std::thread producer {[&] {
+		for (int i {0}; i < 100; ++i) {
+			std::lock_guard const lock {mutex};
+			exchange.publish(int {i});
+		}
+	}};
+
+	exchange.run(mutex);
+	producer.join();
+
+	ASSERT_EQ(100, received);
+}
+
+TEST(TypeExchange, stop_from_other_thread)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	std::thread stopper {[&] {
+		std::this_thread::sleep_for(10ms);
+		exchange.stop();
+	}};
+
+	exchange.run();
+	stopper.join();
+}
+
+#ifdef __linux__
+TEST(TypeExchange, wait_handle)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	auto const handle {exchange.wait_handle()};
+	ASSERT_GE(handle, 0);
+
+	exchange.wait_and_process(0ms);
+
+	pollfd descriptor {handle, POLLIN, 0};
+	ASSERT_EQ(0, poll(&descriptor, 1, 0));
+
+	exchange.publish(1);
+	ASSERT_EQ(1, poll(&descriptor, 1, 0));
+
+	exchange.wait_and_process(0ms);
+	ASSERT_EQ(0, poll(&descriptor, 1, 0));
+}
+
+TEST(TypeExchange, wait_handle_timed_message)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+	ASSERT_EQ(TypeExchange::Clock::time_point::max(), exchange.next_deadline());
+
+	int value {0};
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+
+	auto const handle {exchange.wait_handle()};
+	ASSERT_GE(handle, 0);
+
+	exchange.wait_and_process(0ms);
+
+	auto const start {TypeExchange::Clock::now()};
+	exchange.publish_after(20ms, 1);
+	ASSERT_GE(exchange.next_deadline(), start + 20ms);
+
+	pollfd descriptor {handle, POLLIN, 0};
+
+	// A poll loop which only has the handle & next_deadline() to go on
+	for (int round {0}; value == 0 && round < 100; ++round) {
+		auto const timeout {std::chrono::ceil<std::chrono::milliseconds>(exchange.next_deadline()
+		                                                                  - TypeExchange::Clock::now())};
+		poll(&descriptor, 1, static_cast<int>(std::max(timeout, 0ms).count()));
+		exchange.wait_and_process(0ms);
+	}
+
+	ASSERT_EQ(1, value);
+	ASSERT_GE(TypeExchange::Clock::now(), start + 20ms);
+	ASSERT_EQ(TypeExchange::Clock::time_point::max(), exchange.next_deadline());
+}
+#endif
+
+TEST(TypeExchange, dispatch_in_parallel)
+{
+	TypeExchange exchange;
+
+	exchange.dispatch_in_parallel<int>(4);
+
+	// Each subscriber owns its own record, so no state is shared
+	std::vector<std::vector<int>> received(64);
+
+	for (auto& record : received) {
+		exchange.subscribe<int>([&record](int const& message) { record.push_back(message); });
+	}
+
+	for (int i {0}; i < 100; ++i) {
+		exchange.publish(int {i});
+	}
+
+	exchange.process_messages();
+
+	std::vector<int> expected;
+	for (int i {0}; i < 100; ++i) {
+		expected.push_back(i);
+	}
+
+	for (auto const& record : received) {
+		ASSERT_EQ(expected, record);
+	}
+}
+
+TEST(TypeExchange, dispatch_in_parallel_uneven_chunks)
+{
+	// A fixed pool, independent of the host's thread count
+	detail::ThreadPool pool {7};
+
+	for (std::size_t count {1}; count <= 40; ++count) {
+		detail::EventHandlerImpl<int> handler;
+		handler.dispatch_in_parallel(pool, 1);
+
+		// Eight chunks at most: 10 subscribers take 2 per chunk, leaving only 5 chunks in use
+		std::vector<std::vector<int>> received(count);
+
+		for (auto& record : received) {
+			handler.subscribe([&record](int const& message) { record.push_back(message); });
+		}
+
+		handler.publish(std::make_unique<int>(1));
+		handler.publish(std::make_unique<int>(2));
+		handler.process_messages();
+
+		for (auto const& record : received) {
+			ASSERT_EQ((std::vector<int> {1, 2}), record) << count << " subscribers";
+		}
+	}
+}
+
+TEST(TypeExchange, dispatch_in_parallel_uses_threads)
+{
+	TypeExchange exchange;
+
+	exchange.dispatch_in_parallel<int>(1);
+
+	std::vector<std::thread::id> threads(8);
+
+	for (auto& thread : threads) {
+		exchange.subscribe<int>([&thread](int const&) { thread = std::this_thread::get_id(); });
+	}
+
+	exchange.publish(1);
+	exchange.process_messages();
+
+	// With one subscriber per chunk, the first chunk runs on the processing thread
+	ASSERT_EQ(std::this_thread::get_id(), threads.front());
+
+	for (auto const& thread : threads) {
+		ASSERT_NE(std::thread::id {}, thread);
+	}
+}
+
+TEST(TypeExchange, dispatch_in_parallel_conflated)
+{
+	TypeExchange exchange;
+
+	exchange.conflate<int>();
+	exchange.dispatch_in_parallel<int>(1);
+
+	std::vector<std::vector<int>> received(4);
+
+	for (auto& record : received) {
+		exchange.subscribe<int>([&record](int const& message) { record.push_back(message); });
+	}
+
+	exchange.publish(1);
+	exchange.publish(2);
+	exchange.process_messages();
+
+	for (auto const& record : received) {
+		ASSERT_EQ(std::vector<int> {2}, record);
+	}
+}
+
+TEST(TypeExchange, dispatch_in_parallel_exception)
+{
+	TypeExchange exchange;
+
+	exchange.dispatch_in_parallel<int>(1);
+
+	std::atomic<int> calls {0};
+
+	for (int i {0}; i < 4; ++i) {
+		exchange.subscribe<int>([&calls, i](int const&) {
+			++calls;
+			if (i == 3) {
+				throw std::runtime_error {"subscriber"};
+			}
+		});
+	}
+
+	exchange.publish(1);
+
+	ASSERT_THROW(exchange.process_messages(), std::runtime_error);
+	ASSERT_EQ(4, calls);
+}
+
+TEST(TypeExchange, memory_usage)
+{
+	TypeExchange exchange;
+
+	exchange.subscribe<int>([](int const&) {});
+	exchange.subscribe<std::string>([](std::string const&) {});
+
+	auto const idle {exchange.memory_usage()};
+
+	ASSERT_EQ(2u, idle.types.size());
+	ASSERT_GT(idle.exchange_bytes, 0u);
+
+	for (auto const& type : idle.types) {
+		ASSERT_EQ(0u, type.queue_bytes);
+		ASSERT_GT(type.subscriber_bytes, 0u);
+		ASSERT_GT(type.handler_bytes, 0u);
+	}
+
+	for (int i {0}; i < 100; ++i) {
+		exchange.publish(int {i});
+	}
+
+	auto const busy {exchange.memory_usage()};
+
+	auto const find = [](MemoryUsage const& usage, std::type_index const type) {
+		return *std::find_if(usage.types.begin(), usage.types.end(), [type](auto const& t) { return t.type == type; });
+	};
+
+	ASSERT_GE(find(busy, typeid(int)).queue_bytes, 100 * sizeof(int));
+	ASSERT_EQ(0u, find(busy, typeid(std::string)).queue_bytes);
+	ASSERT_GT(busy.total(), idle.total());
+
+	exchange.process_messages();
+
+	ASSERT_EQ(0u, find(exchange.memory_usage(), typeid(int)).queue_bytes);
+}
+
+TEST(TypeExchange, shrink_to_fit_keeps_subscriptions)
+{
+	TypeExchange exchange;
+
+	int calls {0};
+	std::vector<SubscriptionId> ids;
+
+	for (int i {0}; i < 100; ++i) {
+		ids.push_back(exchange.subscribe<int>([&calls](int const&) { ++calls; }));
+	}
+
+	for (int i {1}; i < 100; ++i) {
+		exchange.unsubscribe<int>(ids[static_cast<std::size_t>(i)]);
+	}
+
+	auto const before {exchange.memory_usage().types.front().subscriber_bytes};
+
+	exchange.shrink_to_fit();
+
+	ASSERT_LT(exchange.memory_usage().types.front().subscriber_bytes, before);
+
+	exchange.publish(1);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, calls);
+	ASSERT_TRUE(exchange.unsubscribe<int>(ids.front()));
+}
+
+TEST(TypeExchange, shrink_to_fit_frees_timers)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	for (int i {0}; i < 100; ++i) {
+		exchange.publish_after(1ms, int {i});
+	}
+
+	std::this_thread::sleep_for(5ms);
+	exchange.process_messages();
+
+	auto const before {exchange.memory_usage().exchange_bytes};
+
+	exchange.shrink_to_fit();
+
+	ASSERT_LT(exchange.memory_usage().exchange_bytes, before);
+}
+
+TEST(TypeExchange, release_idle)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	auto const id {exchange.subscribe<int>([](int const&) {})};
+	exchange.publish(std::string {"unused"});
+	exchange.process_messages();
+
+	// Not idle for long enough
+	ASSERT_EQ(0u, exchange.release_idle(1h));
+	ASSERT_EQ(2u, exchange.memory_usage().types.size());
+
+	// The subscribed type stays
+	ASSERT_EQ(1u, exchange.release_idle(0s));
+	ASSERT_EQ(1u, exchange.memory_usage().types.size());
+
+	exchange.unsubscribe<int>(id);
+	ASSERT_EQ(1u, exchange.release_idle(0s));
+	ASSERT_TRUE(exchange.memory_usage().types.empty());
+
+	// Released types are recreated on use
+	int value {0};
+	exchange.subscribe<int>([&value](int const& message) { value = message; });
+	exchange.publish(1);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, value);
+}
+
+TEST(TypeExchange, release_idle_never_reuses_ids)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	auto const stale {exchange.subscribe<int>([](int const&) {})};
+	ASSERT_TRUE(exchange.unsubscribe<int>(stale));
+	ASSERT_EQ(1u, exchange.release_idle(0s));
+
+	int calls {0};
+	auto const fresh {exchange.subscribe<int>([&calls](int const&) { ++calls; })};
+
+	ASSERT_NE(stale, fresh);
+	ASSERT_FALSE(exchange.unsubscribe<int>(stale));
+
+	exchange.publish(1);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, calls);
+}
+
+TEST(TypeExchange, subscription_ids_unique_across_types)
+{
+	TypeExchange exchange;
+
+	auto const first {exchange.subscribe<int>([](int const&) {})};
+	auto const second {exchange.subscribe<std::string>([](std::string const&) {})};
+	auto const third {exchange.channel<double>().subscribe([](double const&) {})};
+
+	ASSERT_NE(first, second);
+	ASSERT_NE(second, third);
+	ASSERT_NE(first, third);
+}
+
+TEST(TypeExchange, release_idle_keeps_referenced_types)
+{
+	using namespace std::chrono_literals;
+
+	TypeExchange exchange;
+
+	auto const channel {exchange.channel<int>()};
+	exchange.conflate<std::string>();
+	exchange.publish_after(1h, 1.0);
+	exchange.publish(1.0f);
+
+	ASSERT_EQ(0u, exchange.release_idle(0s));
+	ASSERT_EQ(4u, exchange.memory_usage().types.size());
+
+	// Channels stay usable
+	int value {0};
+	channel.subscribe([&value](int const& message) { value = message; });
+	channel.publish(1);
+	exchange.process_messages();
+
+	ASSERT_EQ(1, value);
+
+	// Once delivered, the float type is no longer referenced
+	ASSERT_EQ(1u, exchange.release_idle(0s));
+	ASSERT_EQ(3u, exchange.memory_usage().types.size());
+}